@@ -0,0 +1,215 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mandelbrot-core/double_double.h"
+#include "mandelbrot-core/fixed_point.h"
+#include "mandelbrot-core/kernel.h"
+#include "mandelbrot-core/limbs.h"
+#include "mandelbrot-core/perturbation.h"
+#include "mandelbrot-core/renderer.h"
+#include "mandelbrot-core/scheduler.h"
+
+// Roughly how long to spend on each measurement
+constexpr double kSecondsPerMeasurement = 1.0;
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// View the escape-time kernels are timed and checked on: seahorse valley,
+// where orbits of every length and cycles of every period meet
+constexpr mandelbrot::Viewport kKernelView = {-0.7600, 0.0850, -0.7400, 0.1050};
+constexpr int kKernelWidth = 320, kKernelHeight = 240;
+constexpr float kKernelMaxIt = 2000.0f;
+
+// Whether `config` stops every pixel of kKernelView where the scalar kernel
+// does, bit for bit, for budgets from none to kKernelMaxIt
+bool MatchesScalar(mandelbrot::KernelConfig config) {
+  std::vector<double> cr, ci;
+  for (int y = 0; y < kKernelHeight; y++) {
+    for (int x = 0; x < kKernelWidth; x++) {
+      double u, v;
+      mandelbrot::PixelToCanvas(x, y, kKernelWidth, kKernelHeight, u, v);
+      mandelbrot::Complex c = kKernelView.At(u, v);
+      cr.push_back(c.re);
+      ci.push_back(c.im);
+    }
+  }
+  int count = static_cast<int>(cr.size());
+  std::vector<mandelbrot::Escape> escapes(count), expected(count);
+  for (int max_iterations : {0, 1, 2, 100, mandelbrot::MaxIterations(kKernelMaxIt)}) {
+    for (bool cardioid_check : {false, true}) {
+      for (double tolerance : {0.0, 1e-3 * (kKernelView.top - kKernelView.bottom) / kKernelHeight}) {
+        config.max_iterations = max_iterations;
+        config.cardioid_check = cardioid_check;
+        config.periodicity_tolerance = tolerance;
+        mandelbrot::KernelConfig scalar = config;
+        scalar.kernel = mandelbrot::Kernel::kScalar;
+        mandelbrot::EscapeTimeBatch(config, cr.data(), ci.data(), count, escapes.data());
+        mandelbrot::EscapeTimeBatch(scalar, cr.data(), ci.data(), count, expected.data());
+        for (int i = 0; i < count; i++) {
+          if (escapes[i].iterations != expected[i].iterations || std::memcmp(&escapes[i].norm, &expected[i].norm, sizeof(double)) != 0 || escapes[i].period != expected[i].period)
+            return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// Mean time of one single-threaded frame of kKernelView
+double FrameSeconds(mandelbrot::Kernel kernel, mandelbrot::LaneMode lane_mode, double periodicity_tolerance = 1e-3) {
+  std::vector<float> iterations(kKernelWidth * kKernelHeight);
+  mandelbrot::IterationBuffer buffer{iterations.data(), kKernelWidth, kKernelHeight};
+  mandelbrot::RenderParams params{kKernelView, kKernelMaxIt, kernel, lane_mode};
+  params.periodicity_tolerance = periodicity_tolerance;
+
+  int count = 0;
+  auto start = std::chrono::steady_clock::now();
+  do {
+    mandelbrot::Render(params, buffer);
+    count++;
+  } while (Seconds(start) < kSecondsPerMeasurement / 4);
+  return Seconds(start) / count;
+}
+
+// Mean time of one single-threaded frame of kKernelView in double-double,
+// as the center of the view plus offsets
+double DoubleDoubleFrameSeconds() {
+  std::vector<float> iterations(kKernelWidth * kKernelHeight);
+  mandelbrot::IterationBuffer buffer{iterations.data(), kKernelWidth, kKernelHeight};
+  double re = (kKernelView.left + kKernelView.right) / 2, im = (kKernelView.bottom + kKernelView.top) / 2;
+  mandelbrot::DoubleDoubleParams params{re, im, {kKernelView.left - re, kKernelView.bottom - im, kKernelView.right - re, kKernelView.top - im}, kKernelMaxIt};
+  mandelbrot::TileScheduler scheduler(1);
+
+  int count = 0;
+  auto start = std::chrono::steady_clock::now();
+  do {
+    mandelbrot::Render(params, buffer, scheduler);
+    count++;
+  } while (Seconds(start) < kSecondsPerMeasurement / 4);
+  return Seconds(start) / count;
+}
+
+// Mean time of one squaring of `limbs` random limbs with `algorithm`
+double SquareSeconds(int limbs, mandelbrot::limbs::Algorithm algorithm) {
+  std::mt19937 random(limbs);
+  std::vector<uint32_t> x(limbs);
+  for (uint32_t &limb : x)
+    limb = static_cast<uint32_t>(random());
+
+  int count = 0;
+  auto start = std::chrono::steady_clock::now();
+  do {
+    volatile uint32_t sink = mandelbrot::limbs::Square(x, algorithm).back();
+    (void) sink;
+    count++;
+  } while (Seconds(start) < kSecondsPerMeasurement / 4);
+  return Seconds(start) / count;
+}
+
+// Whether Karatsuba and the NTT agree with schoolbook multiplication on a
+// square of `limbs` random limbs and on a product with a third as many
+bool MatchesSchoolbook(int limbs) {
+  std::mt19937 random(limbs);
+  std::vector<uint32_t> x(limbs), y(limbs / 3 + 1);
+  for (uint32_t &limb : x)
+    limb = static_cast<uint32_t>(random());
+  for (uint32_t &limb : y)
+    limb = static_cast<uint32_t>(random());
+
+  std::vector<uint32_t> square = mandelbrot::limbs::Square(x, mandelbrot::limbs::Algorithm::kSchoolbook);
+  std::vector<uint32_t> product = mandelbrot::limbs::Multiply(x, y, mandelbrot::limbs::Algorithm::kSchoolbook);
+  for (auto algorithm : {mandelbrot::limbs::Algorithm::kKaratsuba, mandelbrot::limbs::Algorithm::kNtt}) {
+    if (mandelbrot::limbs::Square(x, algorithm) != square || mandelbrot::limbs::Multiply(x, y, algorithm) != product)
+      return false;
+  }
+  return true;
+}
+
+// Mean time of one iteration of the reference orbit at `bits` of precision
+double IterationSeconds(int bits, int &iterations) {
+  int limbs = (bits + 31) / 32;
+  mandelbrot::ReferenceOrbit orbit(*mandelbrot::FixedComplex::Parse("0.36024044343761436323", "-0.64131306106480317486", limbs));
+
+  auto start = std::chrono::steady_clock::now();
+  do {
+    orbit.Extend(static_cast<int>(orbit.points().size()));
+  } while (!orbit.escaped() && Seconds(start) < kSecondsPerMeasurement);
+  iterations = static_cast<int>(orbit.points().size()) - 1;
+  return Seconds(start) / iterations;
+}
+
+const char *Name(mandelbrot::limbs::Algorithm algorithm) {
+  switch (algorithm) {
+    case mandelbrot::limbs::Algorithm::kSchoolbook:
+      return "schoolbook";
+    case mandelbrot::limbs::Algorithm::kKaratsuba:
+      return "karatsuba";
+    case mandelbrot::limbs::Algorithm::kNtt:
+      return "ntt";
+  }
+  return "";
+}
+
+int main(int argc, char **argv) {
+  // Precisions to measure, in bits
+  std::vector<int> precisions = {1000, 10000, 100000};
+  if (argc > 1) {
+    precisions.clear();
+    for (int i = 1; i < argc; i++)
+      precisions.push_back(std::atoi(argv[i]));
+  }
+
+  // Every escape-time kernel the CPU runs, against the scalar reference
+  bool exact = true;
+  std::printf("%-16s %12s %10s %8s\n", "kernel", "frame", "speedup", "exact");
+  double scalar_seconds = FrameSeconds(mandelbrot::Kernel::kScalar, mandelbrot::LaneMode::kMasked);
+  std::printf("%-16s %9.2f ms %9.2fx %8s\n", "scalar", scalar_seconds * 1e3, 1.0, "-");
+  for (auto kernel : {mandelbrot::Kernel::kAvx2, mandelbrot::Kernel::kAvx512}) {
+    if (!mandelbrot::KernelSupported(kernel))
+      continue;
+    for (auto lane_mode : {mandelbrot::LaneMode::kMasked, mandelbrot::LaneMode::kRefill}) {
+      bool matches = MatchesScalar({kernel, lane_mode, 0, false, 0.0});
+      exact = exact && matches;
+      double seconds = FrameSeconds(kernel, lane_mode);
+      std::string name = std::string(mandelbrot::KernelName(kernel)) + (lane_mode == mandelbrot::LaneMode::kMasked ? " masked" : " refill");
+      std::printf("%-16s %9.2f ms %9.2fx %8s\n", name.c_str(), seconds * 1e3, scalar_seconds / seconds, matches ? "yes" : "NO");
+    }
+  }
+  std::printf("\n");
+
+  // What double-double costs over double where both resolve the view; the
+  // double-double kernel has no cycle detection, so neither does the scalar
+  // one here
+  std::printf("%-16s %12s %10s\n", "precision", "frame", "slowdown");
+  double double_seconds = FrameSeconds(mandelbrot::Kernel::kScalar, mandelbrot::LaneMode::kMasked, 0.0);
+  double double_double_seconds = DoubleDoubleFrameSeconds();
+  std::printf("%-16s %9.2f ms %9.2fx\n", "double", double_seconds * 1e3, 1.0);
+  std::printf("%-16s %9.2f ms %9.2fx\n", "double-double", double_double_seconds * 1e3, double_double_seconds / double_seconds);
+  std::printf("\n");
+
+  std::printf("%10s %14s %14s %14s %10s %8s %18s\n", "bits", "schoolbook", "karatsuba", "ntt", "picks", "exact", "orbit/iteration");
+  for (int bits : precisions) {
+    int limbs = (bits + 31) / 32;
+    std::printf("%10d", bits);
+    for (auto algorithm : {mandelbrot::limbs::Algorithm::kSchoolbook, mandelbrot::limbs::Algorithm::kKaratsuba, mandelbrot::limbs::Algorithm::kNtt})
+      std::printf(" %11.2f us", SquareSeconds(limbs, algorithm) * 1e6);
+    std::printf(" %10s", Name(mandelbrot::limbs::AlgorithmFor(limbs, limbs)));
+    bool matches = MatchesSchoolbook(limbs);
+    exact = exact && matches;
+    std::printf(" %8s", matches ? "yes" : "NO");
+    std::fflush(stdout);
+
+    int iterations;
+    double seconds = IterationSeconds(bits, iterations);
+    std::printf(" %15.2f us (%d iterations)\n", seconds * 1e6, iterations);
+  }
+  return exact ? 0 : 1;
+}
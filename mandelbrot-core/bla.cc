@@ -0,0 +1,95 @@
+#include "mandelbrot-core/bla.h"
+
+#include <cmath>
+
+namespace mandelbrot {
+
+namespace {
+
+// The few operations a merge needs, for both kinds of complex
+Complex Multiply(Complex a, Complex b) { return {a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re}; }
+ExpComplex Multiply(const ExpComplex &a, const ExpComplex &b) { return a * b; }
+
+Complex Add(Complex a, Complex b) { return {a.re + b.re, a.im + b.im}; }
+ExpComplex Add(const ExpComplex &a, const ExpComplex &b) { return a + b; }
+
+double Abs(Complex a) { return std::hypot(a.re, a.im); }
+FloatExp Abs(const ExpComplex &a) { return a.Abs(); }
+
+// Step `x` followed by step `y`: d'' = a_y (a_x d + b_x dc) + b_y dc, valid
+// while d is within x's radius and a_x d + b_x dc within y's
+template <typename C, typename R>
+BasicBlaStep<C, R> Merge(const BasicBlaStep<C, R> &x, const BasicBlaStep<C, R> &y, const R &dc_radius) {
+  R reach = (y.radius - Abs(x.b) * dc_radius) / Abs(x.a);
+  R zero = 0.0;
+  R radius = x.radius < reach ? x.radius : reach > zero ? reach : zero;
+  return {
+      Multiply(y.a, x.a),
+      Add(Multiply(y.a, x.b), y.b),
+      radius,
+      radius * radius,
+      x.length + y.length,
+  };
+}
+
+};  // namespace
+
+template <typename C, typename R>
+BasicBlaTable<C, R>::BasicBlaTable(const ReferenceOrbit &reference, R dc_radius) {
+  const std::vector<Complex> &orbit = reference.points();
+  int last = static_cast<int>(orbit.size()) - 1;
+  if (last < 2)
+    return;
+
+  // Z_last lies past the bailout, so steps run from Z_1 up to Z_{last - 1}
+  std::vector<Step> &single = levels_.emplace_back();
+  single.reserve(last - 1);
+  for (int m = 1; m < last; m++) {
+    Complex z = orbit[m];
+    R radius = kBlaEpsilon * Abs(z);
+    single.push_back({C(Complex{2 * z.re, 2 * z.im}), C(Complex{1.0, 0.0}), radius, radius * radius, 1});
+  }
+  singles_ = single.size();
+
+  while (levels_.back().size() >= 2) {
+    const std::vector<Step> &below = levels_.back();
+    std::vector<Step> above;
+    above.reserve(below.size() / 2);
+    for (size_t j = 0; j + 1 < below.size(); j += 2)
+      above.push_back(Merge(below[j], below[j + 1], dc_radius));
+    levels_.push_back(std::move(above));
+  }
+}
+
+template <typename C, typename R>
+const typename BasicBlaTable<C, R>::Step *BasicBlaTable<C, R>::Climb(int m, const R &delta_norm, int limit) const {
+  // A merged step is never valid where its first half is not, so climb
+  // from the single step for as long as the steps stay aligned and valid
+  const Step *best = nullptr;
+  int index = m - 1;
+  for (const std::vector<Step> &level : levels_) {
+    if (index >= static_cast<int>(level.size()))
+      break;
+    const Step &step = level[index];
+    if (step.length > limit || delta_norm >= step.radius2)
+      break;
+    best = &step;
+    if (index & 1)
+      break;
+    index >>= 1;
+  }
+  return best;
+}
+
+template <typename C, typename R>
+size_t BasicBlaTable<C, R>::bytes() const {
+  size_t bytes = 0;
+  for (const std::vector<Step> &level : levels_)
+    bytes += level.capacity() * sizeof(Step);
+  return bytes;
+}
+
+template class BasicBlaTable<Complex, double>;
+template class BasicBlaTable<ExpComplex, FloatExp>;
+
+};  // namespace mandelbrot
@@ -0,0 +1,72 @@
+#ifndef MANDELBROT_CORE_BLA_H_
+#define MANDELBROT_CORE_BLA_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "mandelbrot-core/float_exp.h"
+#include "mandelbrot-core/perturbation.h"
+#include "mandelbrot-core/viewport.h"
+
+namespace mandelbrot {
+
+// Bilinear approximation of `length` perturbation steps from some point of
+// the reference orbit: d' = a d + b dc, exact to kBlaEpsilon while |d| stays
+// below `radius`. C is Complex with R double, or ExpComplex with R FloatExp
+// for views whose deltas underflow a double.
+template <typename C, typename R>
+struct BasicBlaStep {
+  C a;
+  C b;
+  R radius;
+  R radius2;  // radius^2, for comparing with squared norms
+  int length;
+};
+
+// Relative error a BLA step may introduce
+inline constexpr double kBlaEpsilon = 0x1p-40;
+
+// Hierarchy of BLA steps along a reference orbit. Level 0 holds the single
+// steps from Z_m, m >= 1, where |d|^2 is negligible next to |2 Z_m d|; each
+// level above merges pairs of the level below, so level l jumps 2^l
+// iterations from every m = 1 + j 2^l. The radii account for dc up to
+// `dc_radius`, the largest offset of the view, so the table is rebuilt with
+// the view.
+template <typename C, typename R>
+class BasicBlaTable {
+ public:
+  using Step = BasicBlaStep<C, R>;
+
+  BasicBlaTable() = default;
+  BasicBlaTable(const ReferenceOrbit &reference, R dc_radius);
+
+  // The longest step from Z_m valid for a delta of squared norm
+  // `delta_norm` and no longer than `limit`, or nullptr if there is none
+  const Step *Lookup(int m, const R &delta_norm, int limit) const {
+    // Most lookups fail on the single step, so reject those inline
+    if (m < 1 || m > static_cast<int>(singles_) || delta_norm >= levels_[0][m - 1].radius2)
+      return nullptr;
+    return Climb(m, delta_norm, limit);
+  }
+
+  int levels() const { return static_cast<int>(levels_.size()); }
+  size_t bytes() const;
+
+ private:
+  const Step *Climb(int m, const R &delta_norm, int limit) const;
+
+  std::vector<std::vector<Step>> levels_;
+  size_t singles_ = 0;
+};
+
+using BlaStep = BasicBlaStep<Complex, double>;
+using BlaTable = BasicBlaTable<Complex, double>;
+using ExpBlaStep = BasicBlaStep<ExpComplex, FloatExp>;
+using ExpBlaTable = BasicBlaTable<ExpComplex, FloatExp>;
+
+extern template class BasicBlaTable<Complex, double>;
+extern template class BasicBlaTable<ExpComplex, FloatExp>;
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_BLA_H_
@@ -0,0 +1,41 @@
+#include "mandelbrot-core/double_double.h"
+
+namespace mandelbrot {
+
+Escape EscapeTime(DoubleDouble cr, DoubleDouble ci, int max_iterations) {
+  DoubleDouble zx, zy;
+  DoubleDouble zx2, zy2;
+
+  int it = 0;
+  for (; it < max_iterations && zx2.hi + zy2.hi <= kBailout; it++) {
+    DoubleDouble zxy = zx * zy;
+    zy = zxy + zxy + ci;
+    zx = zx2 - zy2 + cr;
+    zx2 = zx * zx;
+    zy2 = zy * zy;
+  }
+  return {it, zx2.hi + zy2.hi};
+}
+
+void Render(const DoubleDoubleParams &params, IterationBuffer &buffer, TileScheduler &scheduler) {
+  int max_iterations = MaxIterations(params.max_it);
+  scheduler.Run(SplitIntoTiles(buffer.width, buffer.height, params.tile_size), [&](const Tile &tile) {
+    for (int y = tile.y; y < tile.y + tile.height; y++) {
+      for (int x = tile.x; x < tile.x + tile.width; x++) {
+        double u, v;
+        PixelToCanvas(x, y, buffer.width, buffer.height, u, v);
+        Complex offset = params.offset.At(u, v);
+        DoubleDouble cr = params.re + offset.re, ci = params.im + offset.im;
+
+        // The bulbs are far wider than a double can resolve
+        if (params.cardioid_check && InCardioidOrBulb({cr.hi, ci.hi})) {
+          buffer.At(x, y) = kInterior;
+          continue;
+        }
+        buffer.At(x, y) = SmoothIteration(EscapeTime(cr, ci, max_iterations), max_iterations);
+      }
+    }
+  });
+}
+
+};  // namespace mandelbrot
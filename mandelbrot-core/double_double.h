@@ -0,0 +1,110 @@
+#ifndef MANDELBROT_CORE_DOUBLE_DOUBLE_H_
+#define MANDELBROT_CORE_DOUBLE_DOUBLE_H_
+
+#include <cmath>
+
+#include "mandelbrot-core/escape_time.h"
+#include "mandelbrot-core/fixed_point.h"
+#include "mandelbrot-core/renderer.h"
+#include "mandelbrot-core/scheduler.h"
+#include "mandelbrot-core/viewport.h"
+
+namespace mandelbrot {
+
+// Pixel spacing, relative to |c|, below which double-double (106 bits) can
+// no longer tell neighbouring pixels apart, with the same margin as
+// kDoubleSpacingLimit.
+inline constexpr double kDoubleDoubleSpacingLimit = 1e-29;
+
+// Unevaluated sum hi + lo with |lo| <= ulp(hi) / 2, built from error-free
+// transforms of doubles. They only hold if the compiler neither fuses nor
+// reassociates them, hence -ffp-contract=off on this library.
+struct DoubleDouble {
+  double hi = 0.0;
+  double lo = 0.0;
+
+  DoubleDouble() = default;
+  DoubleDouble(double value) : hi(value) {}
+  DoubleDouble(double hi, double lo) : hi(hi), lo(lo) {}
+
+  // The 106 leading bits of `value`
+  static DoubleDouble From(const FixedPoint &value) {
+    double hi = value.ToDouble();
+    return {hi, (value - FixedPoint(hi, value.fraction_limbs())).ToDouble()};
+  }
+};
+
+namespace double_double {
+
+// s + e = a + b exactly
+inline DoubleDouble TwoSum(double a, double b) {
+  double s = a + b;
+  double bb = s - a;
+  return {s, (a - (s - bb)) + (b - bb)};
+}
+
+// TwoSum() for |a| >= |b|
+inline DoubleDouble QuickTwoSum(double a, double b) {
+  double s = a + b;
+  return {s, b - (s - a)};
+}
+
+// p + e = a b exactly
+inline DoubleDouble TwoProduct(double a, double b) {
+  double p = a * b;
+#ifdef __FMA__
+  return {p, std::fma(a, b, -p)};
+#else
+  // Dekker: split both factors into 26-bit halves whose products are exact
+  constexpr double kSplit = 134217729.0;  // 2^27 + 1
+  double ta = kSplit * a, tb = kSplit * b;
+  double a_hi = ta - (ta - a), b_hi = tb - (tb - b);
+  double a_lo = a - a_hi, b_lo = b - b_hi;
+  return {p, ((a_hi * b_hi - p) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo};
+#endif
+}
+
+};  // namespace double_double
+
+inline DoubleDouble operator+(const DoubleDouble &a, const DoubleDouble &b) {
+  DoubleDouble s = double_double::TwoSum(a.hi, b.hi);
+  DoubleDouble t = double_double::TwoSum(a.lo, b.lo);
+  s.lo += t.hi;
+  s = double_double::QuickTwoSum(s.hi, s.lo);
+  s.lo += t.lo;
+  return double_double::QuickTwoSum(s.hi, s.lo);
+}
+
+inline DoubleDouble operator-(const DoubleDouble &a) { return {-a.hi, -a.lo}; }
+
+inline DoubleDouble operator-(const DoubleDouble &a, const DoubleDouble &b) { return a + -b; }
+
+inline DoubleDouble operator*(const DoubleDouble &a, const DoubleDouble &b) {
+  DoubleDouble p = double_double::TwoProduct(a.hi, b.hi);
+  p.lo += a.hi * b.lo + a.lo * b.hi;
+  return double_double::QuickTwoSum(p.hi, p.lo);
+}
+
+// The escape-time loop of mandelbrot.frag in double-double, for views past
+// kDoubleSpacingLimit. The bailout test only needs the high parts.
+Escape EscapeTime(DoubleDouble cr, DoubleDouble ci, int max_iterations);
+
+// A view too deep for doubles but within kDoubleDoubleSpacingLimit: the
+// point zoomed into, in double-double, and the lbrt corners as offsets from
+// it.
+struct DoubleDoubleParams {
+  DoubleDouble re;
+  DoubleDouble im;
+  Viewport offset;
+  float max_it;
+
+  bool cardioid_check = true;
+  int tile_size = 64;
+};
+
+// Renders the whole buffer in double-double on every thread of `scheduler`.
+void Render(const DoubleDoubleParams &params, IterationBuffer &buffer, TileScheduler &scheduler);
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_DOUBLE_DOUBLE_H_
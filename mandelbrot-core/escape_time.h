@@ -0,0 +1,108 @@
+#ifndef MANDELBROT_CORE_ESCAPE_TIME_H_
+#define MANDELBROT_CORE_ESCAPE_TIME_H_
+
+#include <cmath>
+#include <limits>
+
+#include "mandelbrot-core/viewport.h"
+
+namespace mandelbrot {
+
+// Squared magnitude past which an orbit has escaped (`1 << 16` in the shader).
+inline constexpr double kBailout = 1 << 16;
+
+// Value written to the iteration buffer for pixels that never escaped.
+inline constexpr float kInterior = std::numeric_limits<float>::infinity();
+
+// Iteration budget of a float `maxIt`: the shader keeps iterating while the
+// float counter is below it, so a fractional budget rounds up.
+inline int MaxIterations(float max_it) {
+  return static_cast<int>(std::ceil(max_it));
+}
+
+// Where the orbit of a pixel stopped.
+struct Escape {
+  int iterations;  // Iterations run before the bailout test failed
+  double norm;     // |z|^2 after the last iteration
+  int period = 0;  // Period of the attracting cycle, if one was found
+};
+
+// Closed-form membership tests for the main cardioid (period 1) and the
+// period-2 bulb. Their points never escape, so the loop can be skipped.
+inline bool InMainCardioid(Complex c) {
+  double x = c.re - 0.25;
+  double y2 = c.im * c.im;
+  double q = x * x + y2;
+  return q * (q + x) <= 0.25 * y2;
+}
+
+inline bool InPeriod2Bulb(Complex c) {
+  return (c.re + 1) * (c.re + 1) + c.im * c.im <= 0.0625;
+}
+
+inline bool InCardioidOrBulb(Complex c) {
+  return InMainCardioid(c) || InPeriod2Bulb(c);
+}
+
+// The escape-time loop of mandelbrot.frag, operation for operation.
+inline Escape EscapeTime(Complex c, int max_iterations) {
+  double zx = 0.0, zy = 0.0;
+  double zx2 = 0.0, zy2 = 0.0;
+
+  int it = 0;
+  for (; it < max_iterations && zx2 + zy2 <= kBailout; it++) {
+    zy = 2 * zx * zy + c.im;
+    zx = zx2 - zy2 + c.re;
+    zx2 = zx * zx;
+    zy2 = zy * zy;
+  }
+  return {it, zx2 + zy2};
+}
+
+// EscapeTime() with Brent's cycle detection. z is compared with a copy saved
+// at every power-of-two iteration; an orbit that comes back within
+// `tolerance` of it has settled into a cycle and will never escape, so it
+// reports the whole budget, a norm of 0 and the cycle length (which can be
+// a multiple of the period when the orbit converges slowly).
+inline Escape EscapeTimeBrent(Complex c, int max_iterations, double tolerance) {
+  double tolerance2 = tolerance * tolerance;
+  double zx = 0.0, zy = 0.0;
+  double zx2 = 0.0, zy2 = 0.0;
+  double sx = 0.0, sy = 0.0;
+  int saved = 0;
+  long long save_at = 1;
+
+  int it = 0;
+  for (; it < max_iterations && zx2 + zy2 <= kBailout; it++) {
+    zy = 2 * zx * zy + c.im;
+    zx = zx2 - zy2 + c.re;
+    zx2 = zx * zx;
+    zy2 = zy * zy;
+
+    double dx = zx - sx, dy = zy - sy;
+    if (dx * dx + dy * dy <= tolerance2)
+      return {max_iterations, 0.0, it + 1 - saved};
+    if (it + 1 == save_at) {
+      sx = zx;
+      sy = zy;
+      saved = it + 1;
+      save_at *= 2;
+    }
+  }
+  return {it, zx2 + zy2};
+}
+
+// Smooth ("normalized") iteration count of an escaped orbit, `it + 1 - nu`
+// in the shader, or kInterior if the budget ran out first.
+inline float SmoothIteration(const Escape &escape, int max_iterations) {
+  if (escape.iterations >= max_iterations)
+    return kInterior;
+
+  float log_zn = std::log(static_cast<float>(escape.norm)) / 2;
+  float nu = std::log(log_zn / std::log(2.0f)) / std::log(2.0f);
+  return static_cast<float>(escape.iterations) + 1 - nu;
+}
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_ESCAPE_TIME_H_
@@ -0,0 +1,199 @@
+#include "mandelbrot-core/exponential_map.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <numbers>
+#include <string_view>
+
+#include "mandelbrot-core/bla.h"
+#include "mandelbrot-core/escape_time.h"
+#include "mandelbrot-core/perturbation.h"
+#include "mandelbrot-core/tile.h"
+
+namespace mandelbrot {
+
+namespace {
+
+constexpr char kMagic[8] = {'M', 'B', 'E', 'X', 'P', 'M', 'P', '2'};
+
+// Layout of the start of a saved strip, followed by the center as
+// "<re>,<im>" in decimal, exact at center_fraction_limbs, and then the
+// samples row by row
+struct Header {
+  char magic[8];
+  int32_t width;
+  int32_t height;
+  double outer_mantissa;
+  int64_t outer_exponent;
+  float max_it;
+  int32_t center_fraction_limbs;
+  int32_t center_length;
+};
+
+// Interpolates between four samples, or takes the nearest of them if any is
+// interior, which has no count to blend with
+float Bilinear(float s00, float s10, float s01, float s11, double fx, double fy) {
+  if (std::isinf(s00) || std::isinf(s10) || std::isinf(s01) || std::isinf(s11)) {
+    if (fy < 0.5)
+      return fx < 0.5 ? s00 : s10;
+    return fx < 0.5 ? s01 : s11;
+  }
+  double bottom = s00 + (s10 - s00) * fx, top = s01 + (s11 - s01) * fx;
+  return static_cast<float>(bottom + (top - bottom) * fy);
+}
+
+};  // namespace
+
+double ExponentialMap::RowsPerOctave(int width) {
+  return width * std::numbers::ln2 / (2 * std::numbers::pi);
+}
+
+FloatExp ExponentialMap::Radius(double row) const {
+  // e^(-2 pi row / width) underflows doubles past a thousand octaves
+  double octaves = row / RowsPerOctave(width_);
+  double whole = std::floor(octaves);
+  return Ldexp(outer_radius_ * FloatExp(std::exp2(whole - octaves)), -static_cast<int64_t>(whole));
+}
+
+ExponentialMapStats ExponentialMap::Render(const ExponentialMapParams &params, TileScheduler &scheduler) {
+  using Clock = std::chrono::steady_clock;
+  ExponentialMapStats stats{};
+  center_ = params.center;
+  width_ = params.width;
+  outer_radius_ = params.outer_radius;
+  max_it_ = params.max_it;
+  height_ = static_cast<int>(std::ceil((Log(params.outer_radius) - Log(params.inner_radius)) / std::numbers::ln2 * RowsPerOctave(width_))) + 1;
+  samples_.assign(static_cast<size_t>(width_) * height_, 0.0f);
+
+  // The center resolves the samples of the last row
+  int max_iterations = MaxIterations(params.max_it);
+  auto start = Clock::now();
+  FloatExp spacing = Radius(height_ - 1) * FloatExp(2 * std::numbers::pi / width_);
+  ReferenceOrbit reference(params.center.WithFractionLimbs(FixedPoint::FractionLimbsFor(spacing)));
+  reference.Extend(max_iterations);
+  stats.reference_length = static_cast<int>(reference.points().size());
+  stats.reference_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::vector<Complex> directions(width_);
+  for (int column = 0; column < width_; column++) {
+    double angle = 2 * std::numbers::pi * column / width_;
+    directions[column] = {std::cos(angle), std::sin(angle)};
+  }
+
+  // A BLA table holds for every delta up to its radius, so each band of rows
+  // gets one of its own
+  int rows_per_band = std::max(1, static_cast<int>(RowsPerOctave(width_) * kOctavesPerBand));
+  for (int band = 0; band < height_; band += rows_per_band) {
+    int rows = std::min(rows_per_band, height_ - band);
+    FloatExp band_radius = Radius(band);
+    bool float_exp = Radius(band + rows - 1) < FloatExp(kFloatExpRadiusLimit);
+
+    start = Clock::now();
+    BlaTable bla(reference, band_radius.ToDouble());
+    ExpBlaTable exp_bla;
+    if (float_exp)
+      exp_bla = ExpBlaTable(reference, band_radius);
+    auto built = Clock::now();
+    stats.bla_seconds += std::chrono::duration<double>(built - start).count();
+
+    scheduler.Run(SplitIntoTiles(width_, rows, params.tile_size), [&](const Tile &tile) {
+      RebaseCounters counters;
+      for (int y = band + tile.y; y < band + tile.y + tile.height; y++) {
+        FloatExp radius = Radius(y);
+        for (int x = tile.x; x < tile.x + tile.width; x++) {
+          ExpComplex dc = radius * ExpComplex(directions[x]);
+          Escape escape;
+          if (float_exp)
+            escape = RebasedEscapeTime(reference, &exp_bla, &bla, dc, max_iterations, counters);
+          else
+            escape = RebasedEscapeTime(reference, &bla, dc.ToComplex(), 0, {0.0, 0.0}, max_iterations, counters);
+          At(x, y) = SmoothIteration(escape, max_iterations);
+        }
+      }
+    });
+    stats.render_seconds += std::chrono::duration<double>(Clock::now() - built).count();
+    stats.bands++;
+  }
+  return stats;
+}
+
+void ExponentialMap::Resample(const FloatExp &radius, IterationBuffer &frame) const {
+  double log_outer = Log(outer_radius_), log_radius = Log(radius);
+  double rows_per_log = RowsPerOctave(width_) / std::numbers::ln2;
+  double columns_per_angle = width_ / (2 * std::numbers::pi);
+  Viewport unit = {-1.0, -1.0, 1.0, 1.0};
+  for (int y = 0; y < frame.height; y++) {
+    for (int x = 0; x < frame.width; x++) {
+      double u, v;
+      PixelToCanvas(x, y, frame.width, frame.height, u, v);
+      Complex at = unit.At(u, v);
+      double distance = std::hypot(at.re, at.im);
+      double row = distance > 0.0 ? (log_outer - log_radius - std::log(distance)) * rows_per_log : height_ - 1;
+      row = std::clamp(row, 0.0, static_cast<double>(height_ - 1));
+      double column = std::atan2(at.im, at.re) * columns_per_angle;
+      if (column < 0.0)
+        column += width_;
+
+      // Columns wrap around the circle
+      int row0 = std::min(static_cast<int>(row), height_ - 1), row1 = std::min(row0 + 1, height_ - 1);
+      int column0 = static_cast<int>(column) % width_, column1 = (column0 + 1) % width_;
+      frame.At(x, y) = Bilinear(At(column0, row0), At(column1, row0), At(column0, row1), At(column1, row1), column - std::floor(column), row - row0);
+    }
+  }
+}
+
+bool ExponentialMap::Save(const std::string &path) const {
+  std::ofstream out(path, std::ios::binary);
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.width = width_;
+  header.height = height_;
+  header.outer_mantissa = outer_radius_.mantissa();
+  header.outer_exponent = outer_radius_.exponent();
+  header.max_it = max_it_;
+  // Every limb takes 32 decimal digits to write out exactly
+  int digits = 32 * center_.fraction_limbs();
+  std::string center = center_.re.ToString(digits) + "," + center_.im.ToString(digits);
+  header.center_fraction_limbs = center_.fraction_limbs();
+  header.center_length = static_cast<int32_t>(center.size());
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out.write(center.data(), static_cast<std::streamsize>(center.size()));
+  out.write(reinterpret_cast<const char *>(samples_.data()), static_cast<std::streamsize>(samples_.size() * sizeof(float)));
+  return static_cast<bool>(out);
+}
+
+std::optional<ExponentialMap> ExponentialMap::Load(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  Header header;
+  if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+    return std::nullopt;
+  if (header.width <= 0 || header.height <= 0 || header.center_fraction_limbs < 0 || header.center_length <= 0)
+    return std::nullopt;
+
+  std::string center(header.center_length, '\0');
+  if (!in.read(center.data(), header.center_length))
+    return std::nullopt;
+  size_t comma = center.find(',');
+  std::optional<FixedComplex> parsed;
+  if (comma != std::string::npos)
+    parsed = FixedComplex::Parse(std::string_view(center).substr(0, comma), std::string_view(center).substr(comma + 1), header.center_fraction_limbs);
+  if (!parsed)
+    return std::nullopt;
+
+  ExponentialMap map;
+  map.center_ = *parsed;
+  map.width_ = header.width;
+  map.height_ = header.height;
+  map.outer_radius_ = FloatExp(header.outer_mantissa, header.outer_exponent);
+  map.max_it_ = header.max_it;
+  map.samples_.resize(static_cast<size_t>(map.width_) * map.height_);
+  if (!in.read(reinterpret_cast<char *>(map.samples_.data()), static_cast<std::streamsize>(map.samples_.size() * sizeof(float))))
+    return std::nullopt;
+  return map;
+}
+
+};  // namespace mandelbrot
@@ -0,0 +1,89 @@
+#ifndef MANDELBROT_CORE_EXPONENTIAL_MAP_H_
+#define MANDELBROT_CORE_EXPONENTIAL_MAP_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "mandelbrot-core/fixed_point.h"
+#include "mandelbrot-core/float_exp.h"
+#include "mandelbrot-core/renderer.h"
+#include "mandelbrot-core/scheduler.h"
+
+namespace mandelbrot {
+
+// A zoom toward `center`, from the circle of `outer_radius` (through the
+// corners of the first frame) in to `inner_radius` (about a pixel of the
+// last).
+struct ExponentialMapParams {
+  FixedComplex center;
+  FloatExp outer_radius;
+  FloatExp inner_radius;
+  // Samples around each circle; a frame whose corners lie on a circle is
+  // sampled about as finely as its pixels with pi times its diagonal
+  int width;
+  float max_it;
+  int tile_size = 64;
+};
+
+struct ExponentialMapStats {
+  int reference_length;      // Points in the reference orbit
+  double reference_seconds;  // Spent computing the reference orbit
+  double bla_seconds;        // Spent building BLA tables, one per band
+  double render_seconds;     // Spent iterating the samples
+  int bands;                 // Bands of rows sharing a BLA table
+};
+
+// Smoothed iteration counts of a zoom sampled in log-polar coordinates: row
+// k is the circle of radius outer_radius e^(-2 pi k / width) around the
+// center, column j the angle 2 pi j / width. Every frame of the zoom is a
+// window of the same plane, so once the strip is rendered each of them is
+// resampled from it instead of rendered, whatever the timing of the zoom.
+class ExponentialMap {
+ public:
+  // Rows per halving of the radius, which keeps samples square
+  static double RowsPerOctave(int width);
+
+  // Renders the strip by perturbation against the orbit of the center,
+  // always rebased. Rows are rendered in bands of kOctavesPerBand octaves,
+  // each with BLA tables for its own outer radius.
+  ExponentialMapStats Render(const ExponentialMapParams &params, TileScheduler &scheduler);
+
+  // Fills `frame` with the view of half-height `radius` around the center,
+  // laid out like the views of PixelToCanvas(), by bilinear interpolation
+  // of the strip. Pixels past either end of the strip take its first or
+  // last row.
+  void Resample(const FloatExp &radius, IterationBuffer &frame) const;
+
+  // Writes the strip to `path` in a raw binary format with the byte order
+  // of the host; false if it could not be written
+  bool Save(const std::string &path) const;
+  // Reads a strip written by Save(), if `path` holds one
+  static std::optional<ExponentialMap> Load(const std::string &path);
+
+  const FixedComplex &center() const { return center_; }
+  int width() const { return width_; }
+  int height() const { return height_; }
+  const FloatExp &outer_radius() const { return outer_radius_; }
+  float max_it() const { return max_it_; }
+
+  // Radius of (fractional) row `row`
+  FloatExp Radius(double row) const;
+
+  float &At(int column, int row) { return samples_[static_cast<size_t>(row) * width_ + column]; }
+  const float &At(int column, int row) const { return samples_[static_cast<size_t>(row) * width_ + column]; }
+
+ private:
+  static constexpr int kOctavesPerBand = 16;
+
+  FixedComplex center_;
+  int width_ = 0;
+  int height_ = 0;
+  FloatExp outer_radius_;
+  float max_it_ = 0.0f;
+  std::vector<float> samples_;
+};
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_EXPONENTIAL_MAP_H_
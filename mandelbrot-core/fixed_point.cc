@@ -0,0 +1,239 @@
+#include "mandelbrot-core/fixed_point.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mandelbrot-core/limbs.h"
+#include "mandelbrot-core/task_pool.h"
+
+namespace mandelbrot {
+
+FixedPoint::FixedPoint(double value, int fraction_limbs)
+    : negative_(value < 0), limbs_(std::max(fraction_limbs, 0) + 1, 0) {
+  // Peel 32 bits at a time; every step is exact in double
+  double magnitude = std::fabs(value);
+  for (uint32_t &limb : limbs_) {
+    double whole = std::floor(magnitude);
+    limb = static_cast<uint32_t>(whole);
+    magnitude = std::ldexp(magnitude - whole, 32);
+  }
+  if (IsZero())
+    negative_ = false;
+}
+
+std::optional<FixedPoint> FixedPoint::Parse(std::string_view decimal, int fraction_limbs) {
+  bool negative = !decimal.empty() && decimal[0] == '-';
+  if (!decimal.empty() && (decimal[0] == '-' || decimal[0] == '+'))
+    decimal.remove_prefix(1);
+  size_t point = decimal.find('.');
+  std::string_view whole = decimal.substr(0, point);
+  std::string_view fraction = point == std::string_view::npos ? std::string_view() : decimal.substr(point + 1);
+  if (whole.empty() && fraction.empty())
+    return std::nullopt;
+
+  uint64_t integer = 0;
+  for (char digit : whole) {
+    if (digit < '0' || digit > '9')
+      return std::nullopt;
+    integer = 10 * integer + (digit - '0');
+    if (integer > UINT32_MAX)
+      return std::nullopt;
+  }
+  std::vector<uint32_t> digits;
+  digits.reserve(fraction.size());
+  for (char digit : fraction) {
+    if (digit < '0' || digit > '9')
+      return std::nullopt;
+    digits.push_back(digit - '0');
+  }
+
+  // log2(10) < 3.33 bits per digit
+  if (fraction_limbs < 0)
+    fraction_limbs = std::max(1, static_cast<int>((digits.size() * 333 / 100 + 32) / 32));
+
+  // Each limb is the carry out of the decimal fraction times 2^32
+  FixedPoint out(0.0, fraction_limbs);
+  out.limbs_[0] = static_cast<uint32_t>(integer);
+  for (int i = 1; i <= fraction_limbs; i++) {
+    uint64_t carry = 0;
+    for (int j = static_cast<int>(digits.size()) - 1; j >= 0; j--) {
+      uint64_t t = (static_cast<uint64_t>(digits[j]) << 32) + carry;
+      digits[j] = static_cast<uint32_t>(t % 10);
+      carry = t / 10;
+    }
+    out.limbs_[i] = static_cast<uint32_t>(carry);
+  }
+  out.negative_ = negative && !out.IsZero();
+  return out;
+}
+
+int FixedPoint::FractionLimbsFor(double spacing, int guard_bits) {
+  int bits = spacing > 0 ? static_cast<int>(std::ceil(-std::log2(spacing))) : 0;
+  return std::max(1, (std::max(bits, 0) + guard_bits + 31) / 32);
+}
+
+int FixedPoint::FractionLimbsFor(const FloatExp &spacing, int guard_bits) {
+  // -log2 of a mantissa in [1, 2) rounds up to 0
+  int64_t bits = spacing > FloatExp(0.0) ? -spacing.exponent() : 0;
+  return std::max<int>(1, static_cast<int>((std::max<int64_t>(bits, 0) + guard_bits + 31) / 32));
+}
+
+double FixedPoint::ToDouble() const {
+  // Three limbs cover the 53 bits of a double whatever the leading zeros
+  int first = 0;
+  while (first < static_cast<int>(limbs_.size()) - 1 && limbs_[first] == 0)
+    first++;
+
+  double value = 0.0;
+  for (int i = std::min(first + 2, static_cast<int>(limbs_.size()) - 1); i >= first; i--)
+    value += std::ldexp(static_cast<double>(limbs_[i]), -32 * i);
+  return negative_ ? -value : value;
+}
+
+std::string FixedPoint::ToString(int digits) const {
+  std::string out = (negative_ ? "-" : "") + std::to_string(limbs_[0]);
+  if (digits <= 0)
+    return out;
+
+  // Each digit is the carry out of the fraction times 10
+  out += '.';
+  std::vector<uint32_t> fraction(limbs_.begin() + 1, limbs_.end());
+  for (int i = 0; i < digits; i++) {
+    uint64_t carry = 0;
+    for (int j = static_cast<int>(fraction.size()) - 1; j >= 0; j--) {
+      uint64_t t = static_cast<uint64_t>(fraction[j]) * 10 + carry;
+      fraction[j] = static_cast<uint32_t>(t);
+      carry = t >> 32;
+    }
+    out += static_cast<char>('0' + carry);
+  }
+  return out;
+}
+
+FixedPoint FixedPoint::WithFractionLimbs(int fraction_limbs) const {
+  FixedPoint out = *this;
+  out.limbs_.resize(std::max(fraction_limbs, 0) + 1, 0);
+  if (out.IsZero())
+    out.negative_ = false;
+  return out;
+}
+
+FixedPoint FixedPoint::operator-() const {
+  FixedPoint out = *this;
+  out.negative_ = !negative_ && !IsZero();
+  return out;
+}
+
+FixedPoint operator+(const FixedPoint &a, const FixedPoint &b) {
+  FixedPoint out;
+  out.limbs_.assign(a.limbs_.size(), 0);
+  if (a.negative_ == b.negative_) {
+    FixedPoint::AddMagnitudes(a, b, out);
+    out.negative_ = a.negative_;
+  } else if (FixedPoint::CompareMagnitudes(a, b) >= 0) {
+    FixedPoint::SubtractMagnitudes(a, b, out);
+    out.negative_ = a.negative_;
+  } else {
+    FixedPoint::SubtractMagnitudes(b, a, out);
+    out.negative_ = b.negative_;
+  }
+  if (out.IsZero())
+    out.negative_ = false;
+  return out;
+}
+
+FixedPoint operator-(const FixedPoint &a, const FixedPoint &b) {
+  return a + -b;
+}
+
+FixedPoint operator*(const FixedPoint &a, const FixedPoint &b) {
+  // limbs:: works least significant limb first
+  std::vector<uint32_t> x(a.limbs_.rbegin(), a.limbs_.rend());
+  std::vector<uint32_t> y(b.limbs_.rbegin(), b.limbs_.rend());
+  return FixedPoint::FromProduct(limbs::Multiply(x, y), a.fraction_limbs(), b.fraction_limbs(), a.negative_ != b.negative_);
+}
+
+FixedPoint FixedPoint::Square() const {
+  std::vector<uint32_t> x(limbs_.rbegin(), limbs_.rend());
+  return FromProduct(limbs::Square(x), fraction_limbs(), fraction_limbs(), false);
+}
+
+bool operator==(const FixedPoint &a, const FixedPoint &b) {
+  return a.negative_ == b.negative_ && a.limbs_ == b.limbs_;
+}
+
+FixedPoint FixedPoint::FromProduct(const std::vector<uint32_t> &product, int fraction_limbs, int other_fraction_limbs, bool negative) {
+  // Limb i of the product is worth 2^(32 (i - fraction_limbs -
+  // other_fraction_limbs)); carries out of the integer part are dropped
+  FixedPoint out;
+  out.limbs_.resize(fraction_limbs + 1);
+  for (int i = 0; i <= fraction_limbs; i++)
+    out.limbs_[i] = product[fraction_limbs + other_fraction_limbs - i];
+  out.negative_ = negative && !out.IsZero();
+  return out;
+}
+
+void FixedPoint::AddMagnitudes(const FixedPoint &a, const FixedPoint &b, FixedPoint &out) {
+  uint64_t carry = 0;
+  for (int i = static_cast<int>(out.limbs_.size()) - 1; i >= 0; i--) {
+    uint64_t t = static_cast<uint64_t>(a.Limb(i)) + b.Limb(i) + carry;
+    out.limbs_[i] = static_cast<uint32_t>(t);
+    carry = t >> 32;
+  }
+}
+
+void FixedPoint::SubtractMagnitudes(const FixedPoint &a, const FixedPoint &b, FixedPoint &out) {
+  int64_t borrow = 0;
+  for (int i = static_cast<int>(out.limbs_.size()) - 1; i >= 0; i--) {
+    int64_t t = static_cast<int64_t>(a.Limb(i)) - b.Limb(i) - borrow;
+    borrow = t < 0;
+    out.limbs_[i] = static_cast<uint32_t>(t + (borrow << 32));
+  }
+}
+
+int FixedPoint::CompareMagnitudes(const FixedPoint &a, const FixedPoint &b) {
+  int n = static_cast<int>(std::max(a.limbs_.size(), b.limbs_.size()));
+  for (int i = 0; i < n; i++) {
+    if (a.Limb(i) != b.Limb(i))
+      return a.Limb(i) < b.Limb(i) ? -1 : 1;
+  }
+  return 0;
+}
+
+bool FixedPoint::IsZero() const {
+  return std::all_of(limbs_.begin(), limbs_.end(), [](uint32_t limb) { return limb == 0; });
+}
+
+FixedComplex FixedComplex::Square() const {
+  FixedPoint x2, y2, xy;
+  auto product = [&](int i) {
+    if (i == 0)
+      x2 = re.Square();
+    else if (i == 1)
+      y2 = im.Square();
+    else
+      xy = re * im;
+  };
+  if (static_cast<size_t>(fraction_limbs()) >= limbs::kParallelThreshold) {
+    TaskPool::Shared().Run(3, product);
+  } else {
+    for (int i = 0; i < 3; i++)
+      product(i);
+  }
+  return {x2 - y2, xy + xy};
+}
+
+std::optional<FixedComplex> FixedComplex::Parse(std::string_view re, std::string_view im, int fraction_limbs) {
+  std::optional<FixedPoint> x = FixedPoint::Parse(re, fraction_limbs);
+  std::optional<FixedPoint> y = FixedPoint::Parse(im, fraction_limbs);
+  if (!x || !y)
+    return std::nullopt;
+  // Padding would lose the digits the shorter part was truncated at
+  if (x->fraction_limbs() < y->fraction_limbs())
+    x = FixedPoint::Parse(re, y->fraction_limbs());
+  else if (y->fraction_limbs() < x->fraction_limbs())
+    y = FixedPoint::Parse(im, x->fraction_limbs());
+  return FixedComplex{*x, *y};
+}
+
+};  // namespace mandelbrot
@@ -0,0 +1,96 @@
+#ifndef MANDELBROT_CORE_FIXED_POINT_H_
+#define MANDELBROT_CORE_FIXED_POINT_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mandelbrot-core/float_exp.h"
+
+namespace mandelbrot {
+
+// Signed fixed-point number of arbitrary precision: a 32-bit integer part
+// followed by a configurable number of 32-bit fraction limbs. Enough for
+// reference orbits, which stay below the bailout radius; results of
+// operations are truncated to the precision of the left operand.
+class FixedPoint {
+ public:
+  FixedPoint() : FixedPoint(0.0, 0) {}
+  FixedPoint(double value, int fraction_limbs);
+
+  // Parses a plain decimal such as "-0.36024044343761436323" with any number
+  // of digits, truncated to `fraction_limbs`, or to as many as the digits
+  // need if negative. Fails on anything else, or past the integer part.
+  static std::optional<FixedPoint> Parse(std::string_view decimal, int fraction_limbs = -1);
+
+  // Limbs needed to resolve `spacing` with `guard_bits` to spare.
+  static int FractionLimbsFor(double spacing, int guard_bits = 64);
+  static int FractionLimbsFor(const FloatExp &spacing, int guard_bits = 64);
+
+  int fraction_limbs() const { return static_cast<int>(limbs_.size()) - 1; }
+  int bits() const { return 32 * fraction_limbs(); }
+
+  double ToDouble() const;
+  // Decimal with `digits` fraction digits, truncated
+  std::string ToString(int digits) const;
+
+  // The same value truncated, or padded with zeros, to `fraction_limbs`
+  FixedPoint WithFractionLimbs(int fraction_limbs) const;
+
+  FixedPoint operator-() const;
+  friend FixedPoint operator+(const FixedPoint &a, const FixedPoint &b);
+  friend FixedPoint operator-(const FixedPoint &a, const FixedPoint &b);
+  friend FixedPoint operator*(const FixedPoint &a, const FixedPoint &b);
+  // *this * *this, for a little over half the work
+  FixedPoint Square() const;
+  friend bool operator==(const FixedPoint &a, const FixedPoint &b);
+
+ private:
+  // Adds (or subtracts) magnitudes, ignoring signs
+  static void AddMagnitudes(const FixedPoint &a, const FixedPoint &b, FixedPoint &out);
+  static void SubtractMagnitudes(const FixedPoint &a, const FixedPoint &b, FixedPoint &out);
+  static int CompareMagnitudes(const FixedPoint &a, const FixedPoint &b);
+  // The leading limbs of an exact limbs:: product of operands with
+  // `fraction_limbs` and `other_fraction_limbs`
+  static FixedPoint FromProduct(const std::vector<uint32_t> &product, int fraction_limbs, int other_fraction_limbs, bool negative);
+  uint32_t Limb(int i) const { return i < static_cast<int>(limbs_.size()) ? limbs_[i] : 0; }
+  bool IsZero() const;
+
+  bool negative_ = false;
+  // Magnitude, most significant first: limbs_[0] is the integer part and
+  // limbs_[i] is worth 2^(-32 i)
+  std::vector<uint32_t> limbs_;
+};
+
+// Complex number of two FixedPoints, for points too precise for doubles
+struct FixedComplex {
+  FixedPoint re;
+  FixedPoint im;
+
+  // Parses both parts as FixedPoint::Parse() does, at the precision of the
+  // longer one if `fraction_limbs` is negative
+  static std::optional<FixedComplex> Parse(std::string_view re, std::string_view im, int fraction_limbs = -1);
+
+  int fraction_limbs() const { return re.fraction_limbs(); }
+  FixedComplex WithFractionLimbs(int fraction_limbs) const {
+    return {re.WithFractionLimbs(fraction_limbs), im.WithFractionLimbs(fraction_limbs)};
+  }
+  Complex ToComplex() const { return {re.ToDouble(), im.ToDouble()}; }
+
+  friend FixedComplex operator+(const FixedComplex &a, const FixedComplex &b) { return {a.re + b.re, a.im + b.im}; }
+  friend FixedComplex operator-(const FixedComplex &a, const FixedComplex &b) { return {a.re - b.re, a.im - b.im}; }
+  friend FixedComplex operator*(const FixedComplex &a, const FixedComplex &b) {
+    return {a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re};
+  }
+  friend bool operator==(const FixedComplex &a, const FixedComplex &b) { return a.re == b.re && a.im == b.im; }
+
+  // z^2 in three products instead of four, run on TaskPool::Shared() for
+  // operands past limbs::kParallelThreshold
+  FixedComplex Square() const;
+};
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_FIXED_POINT_H_
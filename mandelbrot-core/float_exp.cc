@@ -0,0 +1,26 @@
+#include "mandelbrot-core/float_exp.h"
+
+#include <cmath>
+
+namespace mandelbrot {
+
+void FloatExp::Decimal(double &mantissa, int64_t &exponent) const {
+  if (mantissa_ == 0.0) {
+    mantissa = 0.0;
+    exponent = 0;
+    return;
+  }
+  double log10 = static_cast<double>(exponent_) * std::log10(2.0) + std::log10(std::fabs(mantissa_));
+  double whole = std::floor(log10);
+  mantissa = std::copysign(std::pow(10.0, log10 - whole), mantissa_);
+  exponent = static_cast<int64_t>(whole);
+}
+
+std::ostream &operator<<(std::ostream &out, const FloatExp &value) {
+  double mantissa;
+  int64_t exponent;
+  value.Decimal(mantissa, exponent);
+  return out << mantissa << "e" << (exponent < 0 ? "-" : "+") << std::llabs(exponent);
+}
+
+};  // namespace mandelbrot
@@ -0,0 +1,232 @@
+#ifndef MANDELBROT_CORE_FLOAT_EXP_H_
+#define MANDELBROT_CORE_FLOAT_EXP_H_
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <ostream>
+
+#include "mandelbrot-core/viewport.h"
+
+namespace mandelbrot {
+
+namespace float_exp {
+
+// Exponent of zero, low enough that zero loses every alignment
+inline constexpr int64_t kZeroExponent = -(int64_t{1} << 40);
+
+// 2^k as a double, for -1022 <= k <= 1023
+inline double Pow2(int64_t k) {
+  return std::bit_cast<double>(static_cast<uint64_t>(k + 1023) << 52);
+}
+
+// Splits `value` into a mantissa with 1 <= |mantissa| < 2, which replaces
+// it, and the power of two it was scaled by
+inline int64_t Normalize(double &value) {
+  uint64_t bits = std::bit_cast<uint64_t>(value);
+  int64_t biased = static_cast<int64_t>((bits >> 52) & 0x7ff);
+  if (biased == 0) {
+    // Zero, or subnormal and only reached by converting from double
+    if (value == 0.0)
+      return kZeroExponent;
+    int exponent;
+    value = 2 * std::frexp(value, &exponent);
+    return exponent - 1;
+  }
+  value = std::bit_cast<double>((bits & ~(uint64_t{0x7ff} << 52)) | (uint64_t{1023} << 52));
+  return biased - 1023;
+}
+
+};  // namespace float_exp
+
+// Double mantissa with a 64-bit exponent of its own, for magnitudes far
+// beyond the 1e+-308 of a double (perturbation deltas of views deeper than
+// 1e300). Two 64-bit fields and no branches on the common paths, so arrays
+// of them vectorize like arrays of doubles; the mantissa keeps 53 bits.
+class FloatExp {
+ public:
+  FloatExp() = default;
+  FloatExp(double value) : mantissa_(value), exponent_(float_exp::Normalize(mantissa_)) {}
+  // mantissa 2^exponent
+  FloatExp(double mantissa, int64_t exponent) : mantissa_(mantissa) {
+    exponent_ = float_exp::Normalize(mantissa_);
+    if (mantissa_ != 0.0)
+      exponent_ += exponent;
+  }
+
+  double mantissa() const { return mantissa_; }
+  int64_t exponent() const { return exponent_; }
+
+  // Rounds to 0 or infinity outside the range of a double
+  double ToDouble() const {
+    if (exponent_ > 1023)
+      return mantissa_ * HUGE_VAL;
+    return exponent_ < -1100 ? 0.0 : std::ldexp(mantissa_, static_cast<int>(exponent_));
+  }
+
+  // floor(log10 |x|) and |x| / 10^that, for printing
+  void Decimal(double &mantissa, int64_t &exponent) const;
+
+  FloatExp operator-() const { return Raw(-mantissa_, exponent_); }
+
+  friend FloatExp operator*(const FloatExp &a, const FloatExp &b) {
+    return FloatExp(a.mantissa_ * b.mantissa_, a.exponent_ + b.exponent_);
+  }
+
+  friend FloatExp operator/(const FloatExp &a, const FloatExp &b) {
+    return FloatExp(a.mantissa_ / b.mantissa_, a.exponent_ - b.exponent_);
+  }
+
+  friend FloatExp operator+(const FloatExp &a, const FloatExp &b) {
+    // Align the smaller operand with the larger; past 64 bits it vanishes
+    int64_t shift = b.exponent_ - a.exponent_;
+    if (shift > 0) {
+      if (shift > 64)
+        return b;
+      return FloatExp(b.mantissa_ + a.mantissa_ * float_exp::Pow2(-shift), b.exponent_);
+    }
+    if (shift < -64)
+      return a;
+    return FloatExp(a.mantissa_ + b.mantissa_ * float_exp::Pow2(shift), a.exponent_);
+  }
+
+  friend FloatExp operator-(const FloatExp &a, const FloatExp &b) { return a + -b; }
+
+  friend bool operator<(const FloatExp &a, const FloatExp &b) {
+    if ((a.mantissa_ < 0) != (b.mantissa_ < 0) || a.mantissa_ == 0.0 || b.mantissa_ == 0.0)
+      return a.mantissa_ < b.mantissa_;
+    if (a.exponent_ != b.exponent_)
+      return (a.exponent_ < b.exponent_) != (a.mantissa_ < 0);
+    return a.mantissa_ < b.mantissa_;
+  }
+  friend bool operator>(const FloatExp &a, const FloatExp &b) { return b < a; }
+  friend bool operator<=(const FloatExp &a, const FloatExp &b) { return !(b < a); }
+  friend bool operator>=(const FloatExp &a, const FloatExp &b) { return !(a < b); }
+
+  friend FloatExp Abs(const FloatExp &a) { return Raw(std::fabs(a.mantissa_), a.exponent_); }
+
+  friend FloatExp Sqrt(const FloatExp &a) {
+    // Halve an even exponent, folding an odd one into the mantissa
+    int64_t odd = a.exponent_ & 1;
+    return FloatExp(std::sqrt(a.mantissa_ * (1 + odd)), (a.exponent_ - odd) / 2);
+  }
+
+  // Natural logarithm of |a|, in range for any a but 0
+  friend double Log(const FloatExp &a) {
+    return std::log(std::fabs(a.mantissa_)) + static_cast<double>(a.exponent_) * std::numbers::ln2;
+  }
+
+  friend FloatExp Ldexp(const FloatExp &a, int64_t exponent) {
+    return a.mantissa_ == 0.0 ? a : Raw(a.mantissa_, a.exponent_ + exponent);
+  }
+
+ private:
+  // Already normalized
+  static FloatExp Raw(double mantissa, int64_t exponent) {
+    FloatExp out;
+    out.mantissa_ = mantissa;
+    out.exponent_ = exponent;
+    return out;
+  }
+
+  double mantissa_ = 0.0;
+  int64_t exponent_ = float_exp::kZeroExponent;
+};
+
+// Prints like a double in scientific notation, "1.25e+400"
+std::ostream &operator<<(std::ostream &out, const FloatExp &value);
+
+// Complex number whose parts share one exponent: (re + i im) 2^exponent with
+// the larger part normalized. Deltas only need the precision of the larger
+// part, and one exponent keeps products to a single normalization.
+class ExpComplex {
+ public:
+  ExpComplex() = default;
+  ExpComplex(Complex value) : ExpComplex(value, 0) {}
+  // value 2^exponent
+  ExpComplex(Complex value, int64_t exponent) : re_(value.re), im_(value.im), exponent_(exponent) { Normalize(); }
+
+  // Rounds to 0 or infinity outside the range of a double
+  Complex ToComplex() const {
+    if (exponent_ > 1023)
+      return {re_ * HUGE_VAL, im_ * HUGE_VAL};
+    if (exponent_ < -1100)
+      return {0.0, 0.0};
+    return {std::ldexp(re_, static_cast<int>(exponent_)), std::ldexp(im_, static_cast<int>(exponent_))};
+  }
+
+  int64_t exponent() const { return exponent_; }
+
+  // |z|^2 and |z|
+  FloatExp Norm() const { return FloatExp(re_ * re_ + im_ * im_, 2 * exponent_); }
+  FloatExp Abs() const { return FloatExp(std::hypot(re_, im_), exponent_); }
+
+  ExpComplex operator-() const { return Raw(-re_, -im_, exponent_); }
+
+  friend ExpComplex operator*(const ExpComplex &a, const ExpComplex &b) {
+    return ExpComplex({a.re_ * b.re_ - a.im_ * b.im_, a.re_ * b.im_ + a.im_ * b.re_}, a.exponent_ + b.exponent_);
+  }
+
+  // A plain complex is taken as is, scaled to the exponent of `b`
+  friend ExpComplex operator*(Complex a, const ExpComplex &b) {
+    return ExpComplex({a.re * b.re_ - a.im * b.im_, a.re * b.im_ + a.im * b.re_}, b.exponent_);
+  }
+
+  friend ExpComplex operator*(const FloatExp &a, const ExpComplex &b) {
+    return ExpComplex({a.mantissa() * b.re_, a.mantissa() * b.im_}, a.exponent() + b.exponent_);
+  }
+
+  friend ExpComplex operator+(const ExpComplex &a, const ExpComplex &b) {
+    int64_t shift = b.exponent_ - a.exponent_;
+    if (shift > 0) {
+      if (shift > 64)
+        return b;
+      double scale = float_exp::Pow2(-shift);
+      return ExpComplex({b.re_ + a.re_ * scale, b.im_ + a.im_ * scale}, b.exponent_);
+    }
+    if (shift < -64)
+      return a;
+    double scale = float_exp::Pow2(shift);
+    return ExpComplex({a.re_ + b.re_ * scale, a.im_ + b.im_ * scale}, a.exponent_);
+  }
+
+  friend ExpComplex operator-(const ExpComplex &a, const ExpComplex &b) { return a + -b; }
+
+ private:
+  static ExpComplex Raw(double re, double im, int64_t exponent) {
+    ExpComplex out;
+    out.re_ = re;
+    out.im_ = im;
+    out.exponent_ = exponent;
+    return out;
+  }
+
+  void Normalize() {
+    double larger = std::fabs(re_) > std::fabs(im_) ? re_ : im_;
+    int64_t shift = float_exp::Normalize(larger);
+    if (shift == float_exp::kZeroExponent) {
+      re_ = im_ = 0.0;
+      exponent_ = float_exp::kZeroExponent;
+      return;
+    }
+    if (shift > -1022 && shift < 1022) {
+      double scale = float_exp::Pow2(-shift);
+      re_ *= scale;
+      im_ *= scale;
+    } else {
+      // Only from plain complexes at the ends of the range of a double
+      re_ = std::ldexp(re_, static_cast<int>(-shift));
+      im_ = std::ldexp(im_, static_cast<int>(-shift));
+    }
+    exponent_ += shift;
+  }
+
+  double re_ = 0.0;
+  double im_ = 0.0;
+  int64_t exponent_ = float_exp::kZeroExponent;
+};
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_FLOAT_EXP_H_
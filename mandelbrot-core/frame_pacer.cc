@@ -0,0 +1,53 @@
+#include "mandelbrot-core/frame_pacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace mandelbrot {
+
+FramePacer::FramePacer(double target_rate)
+    : target_rate_(target_rate), period_(target_rate > 0.0 ? 1.0 / target_rate : 0.0) {}
+
+double FramePacer::Wait() {
+  Clock::time_point now = Clock::now();
+  if (!started_) {
+    started_ = true;
+    deadline_ = last_ = now;
+    return 0.0;
+  }
+
+  double jitter = 0.0;
+  if (period_.count() > 0.0) {
+    deadline_ += std::chrono::duration_cast<Clock::duration>(period_);
+    if (deadline_ <= now) {
+      // Late by however long the deadline has passed
+      late_++;
+      jitter = Seconds(now - deadline_).count();
+      deadline_ = now;
+    } else {
+      Clock::time_point wake = deadline_ - std::chrono::duration_cast<Clock::duration>(oversleep_);
+      if (wake > now) {
+        std::this_thread::sleep_until(wake);
+        Clock::time_point woke = Clock::now();
+        oversleep_ += (Seconds(woke - wake) - oversleep_) * kSmoothing;
+        now = woke;
+      }
+      jitter = std::fabs(Seconds(now - deadline_).count());
+    }
+  }
+
+  double interval = Seconds(now - last_).count();
+  last_ = now;
+  interval_sum_ += interval;
+  jitter_sum_ += jitter;
+  worst_jitter_ = std::max(worst_jitter_, jitter);
+  if (++frames_ == kWindow) {
+    stats_ = {interval_sum_ / frames_, jitter_sum_ / frames_, worst_jitter_, static_cast<double>(late_) / frames_};
+    frames_ = late_ = 0;
+    interval_sum_ = jitter_sum_ = worst_jitter_ = 0.0;
+  }
+  return interval;
+}
+
+};  // namespace mandelbrot
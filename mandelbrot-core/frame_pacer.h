@@ -0,0 +1,63 @@
+#ifndef MANDELBROT_CORE_FRAME_PACER_H_
+#define MANDELBROT_CORE_FRAME_PACER_H_
+
+#include <chrono>
+
+namespace mandelbrot {
+
+// How closely frames kept to their schedule over the last kWindow of them.
+struct PacingStats {
+  double interval;      // Mean time between frame starts, in seconds
+  double jitter;        // Mean distance of frame starts from their deadline
+  double worst_jitter;  // Largest such distance
+  double late;          // Fraction of frames whose work overran the deadline
+};
+
+// Starts frames at a fixed rate by sleeping until each is due, rather than
+// spinning on the clock. Sleeps overshoot by a roughly steady amount, which
+// is learnt and woken up early by, so frames start close to their deadline.
+//
+// Deadlines follow each other by the period; a frame whose work overran its
+// deadline starts at once and the schedule restarts from it, instead of
+// rushing the next frames to catch up.
+class FramePacer {
+ public:
+  // Frames a PacingStats is taken over
+  static constexpr int kWindow = 120;
+  // Weight of the newest sleep in the overshoot estimate
+  static constexpr double kSmoothing = 0.1;
+
+  // `target_rate` frames per second, or 0 to start them without waiting
+  explicit FramePacer(double target_rate);
+
+  // Waits until the next frame is due; the seconds since the last one began
+  double Wait();
+
+  double target_rate() const { return target_rate_; }
+  // Stats of the last complete window, zero until there is one
+  const PacingStats &stats() const { return stats_; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  using Seconds = std::chrono::duration<double>;
+
+  double target_rate_;
+  Seconds period_;
+  // How much later than asked sleeps return
+  Seconds oversleep_{0.0};
+  Clock::time_point deadline_;
+  Clock::time_point last_;
+  bool started_ = false;
+
+  PacingStats stats_{};
+  // Sums of the window under way
+  int frames_ = 0;
+  double interval_sum_ = 0.0;
+  double jitter_sum_ = 0.0;
+  double worst_jitter_ = 0.0;
+  int late_ = 0;
+};
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_FRAME_PACER_H_
@@ -0,0 +1,74 @@
+#include "mandelbrot-core/iteration_control.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mandelbrot {
+
+int HistogramBin(float iterations) {
+  if (std::isinf(iterations))
+    return kHistogramBins - 1;
+  return std::min(static_cast<int>(std::log2(std::max(iterations, 1.0f)) * kHistogramBinsPerOctave), kHistogramBins - 2);
+}
+
+double HistogramBinStart(int bin) {
+  return std::exp2(static_cast<double>(bin) / kHistogramBinsPerOctave);
+}
+
+void CountEscapes(const IterationBuffer &buffer, std::vector<uint32_t> &histogram) {
+  histogram.resize(kHistogramBins);
+  for (int y = 0; y < buffer.height; y++) {
+    for (int x = 0; x < buffer.width; x++)
+      histogram[HistogramBin(buffer.At(x, y))]++;
+  }
+}
+
+IterationController::IterationController(double unresolved_fraction, double budget_seconds)
+    : unresolved_fraction_(unresolved_fraction), budget_seconds_(budget_seconds) {}
+
+IterationController::Decision IterationController::Plan(const std::vector<uint32_t> &histogram, float max_it, double frame_seconds) {
+  // Escapes at or above `iterations`, which bins straddling it count in full
+  auto escapes_from = [&](double iterations) {
+    long long count = 0;
+    for (int bin = kHistogramBins - 2; bin >= 0 && HistogramBinStart(bin + 1) > iterations; bin--)
+      count += histogram[bin];
+    return count;
+  };
+
+  long long escaped = escapes_from(0.0);
+  long long left = escapes_from(max_it / 2.0);
+  double allowed = unresolved_fraction_ * escaped;
+  Decision decision{max_it, escaped > 0 ? static_cast<double>(left) / escaped : 1.0, false};
+
+  float wanted = max_it;
+  if (escaped == 0 || left >= allowed) {
+    wanted = static_cast<float>(max_it * kMaxGrowth);
+  } else {
+    // The lowest bin edge at which the estimate still holds
+    for (int bin = 0; HistogramBinStart(bin) < max_it; bin++) {
+      double candidate = HistogramBinStart(bin);
+      if (escapes_from(candidate / 2) + left < allowed) {
+        wanted = static_cast<float>(std::ceil(candidate));
+        break;
+      }
+    }
+  }
+
+  // Frames that run mostly into maxIt take time in proportion to it, and
+  // stay a step below the last maxIt that did not fit
+  if (budget_seconds_ > 0.0 && frame_seconds > 0.0) {
+    ceiling_ *= kCeilingRelaxation;
+    if (frame_seconds > budget_seconds_)
+      ceiling_ = std::min<double>(ceiling_, max_it);
+    double affordable = std::min(max_it * budget_seconds_ / frame_seconds, ceiling_ / kMaxGrowth);
+    if (wanted > affordable) {
+      // Back down no faster than it grows
+      wanted = static_cast<float>(std::max(affordable, max_it / kMaxGrowth));
+      decision.capped = true;
+    }
+  }
+  decision.max_it = std::max(std::round(wanted), kMinIterations);
+  return decision;
+}
+
+};  // namespace mandelbrot
@@ -0,0 +1,74 @@
+#ifndef MANDELBROT_CORE_ITERATION_CONTROL_H_
+#define MANDELBROT_CORE_ITERATION_CONTROL_H_
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "mandelbrot-core/renderer.h"
+
+namespace mandelbrot {
+
+// Escape counts are histogrammed in kHistogramBinsPerOctave bins per octave
+// of iterations, bin b from 2^(b / kHistogramBinsPerOctave) on, and the last
+// of kHistogramBins for pixels that did not escape; the shaders bin alike.
+inline constexpr int kHistogramBinsPerOctave = 8;
+inline constexpr int kHistogramBins = 256;
+
+// Bin of a pixel `iterations` escaped after, or of an interior one
+int HistogramBin(float iterations);
+
+// Lower edge of bin `bin` in iterations
+double HistogramBinStart(int bin);
+
+// Adds the pixels of `buffer` to `histogram`, of kHistogramBins bins
+void CountEscapes(const IterationBuffer &buffer, std::vector<uint32_t> &histogram);
+
+// Picks maxIt from the escape counts of the last frame: the smallest one
+// that leaves fewer than a fraction of the escaping (boundary) pixels
+// unresolved, within a frame-time budget.
+//
+// Pixels that have not escaped by maxIt are told apart from the interior by
+// the escapes of the last octave below it, (maxIt / 2, maxIt]: close to the
+// boundary as many escape per octave for octaves on end, so about as many
+// are left for the next one. The iterations needed can shrink as well, once
+// both the escapes above half of a lower maxIt and those left over are few
+// enough, so the estimate at that maxIt agrees.
+class IterationController {
+ public:
+  // Growth of maxIt per frame at most, which keeps it from racing past
+  // what the next frames show it needs
+  static constexpr double kMaxGrowth = 1.25;
+  // Least maxIt ever picked
+  static constexpr float kMinIterations = 64.0f;
+  // Growth per frame of the lowest maxIt found over budget, after which it
+  // is tried again: frame time jumps as whole regions stop escaping, so
+  // scaling maxIt by the budget alone would keep overshooting
+  static constexpr double kCeilingRelaxation = 1.01;
+
+  struct Decision {
+    float max_it;
+    // Estimated fraction of the escaping pixels left unresolved at the
+    // maxIt measured
+    double unresolved;
+    // Whether the budget held maxIt below what the estimate asked for
+    bool capped;
+  };
+
+  // `budget_seconds` of 0 leaves maxIt uncapped
+  IterationController(double unresolved_fraction, double budget_seconds);
+
+  // The maxIt for the next frames, from the `histogram` of a frame rendered
+  // at `max_it` in `frame_seconds` (0 if unknown)
+  Decision Plan(const std::vector<uint32_t> &histogram, float max_it, double frame_seconds);
+
+ private:
+  double unresolved_fraction_;
+  double budget_seconds_;
+  // Lowest maxIt whose frame ran over budget, relaxing every frame
+  double ceiling_ = HUGE_VAL;
+};
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_ITERATION_CONTROL_H_
@@ -0,0 +1,121 @@
+#include "mandelbrot-core/kernel.h"
+
+#include <vector>
+
+#include "mandelbrot-core/simd/simd.h"
+
+namespace mandelbrot {
+
+const char *KernelName(Kernel kernel) {
+  switch (kernel) {
+    case Kernel::kAuto: return "auto";
+    case Kernel::kScalar: return "scalar";
+    case Kernel::kAvx2: return "avx2";
+    case Kernel::kAvx512: return "avx512";
+  }
+  return "unknown";
+}
+
+bool KernelSupported(Kernel kernel) {
+  switch (kernel) {
+    case Kernel::kAuto:
+    case Kernel::kScalar:
+      return true;
+#if MANDELBROT_X86_SIMD
+    case Kernel::kAvx2:
+      return __builtin_cpu_supports("avx2");
+    case Kernel::kAvx512:
+      return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+      return false;
+  }
+}
+
+Kernel ResolveKernel(Kernel kernel) {
+  if (kernel != Kernel::kAuto && KernelSupported(kernel))
+    return kernel;
+  if (KernelSupported(Kernel::kAvx512))
+    return Kernel::kAvx512;
+  if (KernelSupported(Kernel::kAvx2))
+    return Kernel::kAvx2;
+  return Kernel::kScalar;
+}
+
+int KernelLanes(Kernel kernel) {
+  switch (kernel) {
+    case Kernel::kAvx2: return 4;
+    case Kernel::kAvx512: return 8;
+    default: return 1;
+  }
+}
+
+namespace {
+
+void Iterate(const KernelConfig &config, const double *cr, const double *ci, int count, Escape *escapes) {
+  bool refill = config.lane_mode == LaneMode::kRefill;
+
+  switch (config.kernel) {
+#if MANDELBROT_X86_SIMD
+    case Kernel::kAvx2:
+      if (refill)
+        simd::EscapeTimeRefillAvx2(config, cr, ci, count, escapes);
+      else
+        simd::EscapeTimeAvx2(config, cr, ci, count, escapes);
+      return;
+    case Kernel::kAvx512:
+      if (refill)
+        simd::EscapeTimeRefillAvx512(config, cr, ci, count, escapes);
+      else
+        simd::EscapeTimeAvx512(config, cr, ci, count, escapes);
+      return;
+#endif
+    default:
+      if (config.periodicity_tolerance > 0) {
+        for (int i = 0; i < count; i++)
+          escapes[i] = EscapeTimeBrent({cr[i], ci[i]}, config.max_iterations, config.periodicity_tolerance);
+      } else {
+        for (int i = 0; i < count; i++)
+          escapes[i] = EscapeTime({cr[i], ci[i]}, config.max_iterations);
+      }
+      return;
+  }
+}
+
+};  // namespace
+
+void EscapeTimeBatch(const KernelConfig &config, const double *cr, const double *ci, int count, Escape *escapes) {
+  if (!config.cardioid_check) {
+    Iterate(config, cr, ci, count, escapes);
+    return;
+  }
+
+  // Only the points outside the cardioid and the bulb reach the kernel, so
+  // vector lanes are not wasted on them
+  thread_local std::vector<double> pending_cr, pending_ci;
+  thread_local std::vector<int> pending_index;
+  thread_local std::vector<Escape> pending_escapes;
+  pending_cr.clear();
+  pending_ci.clear();
+  pending_index.clear();
+
+  for (int i = 0; i < count; i++) {
+    if (InMainCardioid({cr[i], ci[i]})) {
+      escapes[i] = {config.max_iterations, 0.0, 1};
+    } else if (InPeriod2Bulb({cr[i], ci[i]})) {
+      escapes[i] = {config.max_iterations, 0.0, 2};
+    } else {
+      pending_cr.push_back(cr[i]);
+      pending_ci.push_back(ci[i]);
+      pending_index.push_back(i);
+    }
+  }
+
+  int pending = static_cast<int>(pending_index.size());
+  pending_escapes.resize(pending);
+  Iterate(config, pending_cr.data(), pending_ci.data(), pending, pending_escapes.data());
+  for (int i = 0; i < pending; i++)
+    escapes[pending_index[i]] = pending_escapes[i];
+}
+
+};  // namespace mandelbrot
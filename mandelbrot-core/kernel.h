@@ -0,0 +1,51 @@
+#ifndef MANDELBROT_CORE_KERNEL_H_
+#define MANDELBROT_CORE_KERNEL_H_
+
+#include "mandelbrot-core/escape_time.h"
+
+namespace mandelbrot {
+
+// Implementations of the escape-time loop. They all return the same
+// iteration counts and norms, bit for bit, as the scalar reference.
+enum class Kernel {
+  kAuto,    // Widest kernel the running CPU supports
+  kScalar,  // EscapeTime(), one pixel at a time
+  kAvx2,    // 4 pixels per instruction
+  kAvx512,  // 8 pixels per instruction
+};
+
+// How a vector kernel keeps its lanes busy.
+enum class LaneMode {
+  kMasked,  // Each vector of pixels runs until its slowest lane is done
+  kRefill,  // A lane that is done loads the next pending pixel of the batch
+};
+
+struct KernelConfig {
+  Kernel kernel;  // Must be resolved
+  LaneMode lane_mode;
+  int max_iterations;
+  bool cardioid_check;  // Settle InCardioidOrBulb() points before iterating
+  double periodicity_tolerance;  // Brent cycle detection radius, 0 disables it
+};
+
+const char *KernelName(Kernel kernel);
+
+// Whether the running CPU can execute `kernel`.
+bool KernelSupported(Kernel kernel);
+
+// Turns kAuto, or a kernel the CPU cannot execute, into the widest supported
+// kernel.
+Kernel ResolveKernel(Kernel kernel);
+
+// Number of pixels a kernel iterates at once.
+int KernelLanes(Kernel kernel);
+
+// Runs the escape-time loop for `count` points c = (cr[i], ci[i]) and stores
+// where each orbit stopped in `escapes`, as EscapeTimeBrent() would with
+// periodicity detection on and EscapeTime() with it off. Points settled by
+// the cardioid check report the whole budget, a norm of 0 and their period.
+void EscapeTimeBatch(const KernelConfig &config, const double *cr, const double *ci, int count, Escape *escapes);
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_KERNEL_H_
@@ -0,0 +1,171 @@
+#include "mandelbrot-core/keyframes.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <numbers>
+#include <string_view>
+
+#include "mandelbrot-core/escape_time.h"
+
+namespace mandelbrot {
+
+namespace {
+
+constexpr char kMagic[8] = {'M', 'B', 'K', 'E', 'Y', 'F', 'R', '2'};
+
+// Layout of the start of saved keyframes, followed by the center as
+// "<re>,<im>" in decimal, exact at center_fraction_limbs, and then their
+// pixels, the outermost keyframe first
+struct Header {
+  char magic[8];
+  int32_t keyframes;
+  int32_t width;
+  int32_t height;
+  double start_mantissa;
+  int64_t start_exponent;
+  float max_it;
+  int32_t center_fraction_limbs;
+  int32_t center_length;
+};
+
+};  // namespace
+
+KeyframeStats KeyframeSequence::Render(const KeyframeParams &params, TileScheduler &scheduler) {
+  KeyframeStats stats{};
+  center_ = params.center;
+  keyframes_ = params.keyframes;
+  width_ = params.width;
+  height_ = params.height;
+  start_radius_ = params.start_radius;
+  max_it_ = params.max_it;
+  int keyframe_width = width_ * kOversize, keyframe_height = height_ * kOversize;
+  long keyframe_pixels = static_cast<long>(keyframe_width) * keyframe_height;
+  samples_.assign(static_cast<size_t>(keyframe_pixels) * keyframes_, 0.0f);
+
+  // Precision of the deepest keyframe throughout, so its reference orbit is
+  // only ever extended
+  FloatExp spacing = Radius(keyframes_ - 1) * FloatExp(2.0 / keyframe_height);
+  FixedComplex center = params.center.WithFractionLimbs(FixedPoint::FractionLimbsFor(spacing));
+  PerturbationRenderer renderer;
+  auto start = std::chrono::steady_clock::now();
+  for (int k = keyframes_ - 1; k >= 0; k--) {
+    FloatExp radius = Radius(k);
+    double mantissa = radius.mantissa();
+    PerturbationParams perturbation{{center, {-mantissa, -mantissa, mantissa, mantissa}, radius.exponent()}, params.max_it};
+    IterationBuffer keyframe{&samples_[static_cast<size_t>(keyframe_pixels) * k], keyframe_width, keyframe_height};
+    PerturbationStats keyframe_stats = renderer.Render(perturbation, keyframe, scheduler);
+    stats.reference_seconds += keyframe_stats.reference_seconds;
+    stats.pixels += keyframe_pixels;
+  }
+  stats.render_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return stats;
+}
+
+bool KeyframeSequence::Sample(int k, double x, double y, float &value) const {
+  int keyframe_width = width_ * kOversize, keyframe_height = height_ * kOversize;
+  if (x < -0.5 || y < -0.5 || x > keyframe_width - 0.5 || y > keyframe_height - 0.5)
+    return false;
+
+  // Within half a pixel of the edges the edge pixels stretch out
+  x = std::clamp(x, 0.0, keyframe_width - 1.0);
+  y = std::clamp(y, 0.0, keyframe_height - 1.0);
+  int x0 = std::min(static_cast<int>(x), keyframe_width - 2), y0 = std::min(static_cast<int>(y), keyframe_height - 2);
+  double fx = x - x0, fy = y - y0;
+  const float *pixels = &samples_[static_cast<size_t>(keyframe_width) * keyframe_height * k];
+  const float *bottom = pixels + static_cast<size_t>(y0) * keyframe_width + x0, *top = bottom + keyframe_width;
+  if (std::isinf(bottom[0]) || std::isinf(bottom[1]) || std::isinf(top[0]) || std::isinf(top[1])) {
+    const float *row = fy < 0.5 ? bottom : top;
+    value = fx < 0.5 ? row[0] : row[1];
+    return true;
+  }
+  double lower = bottom[0] + (bottom[1] - bottom[0]) * fx, upper = top[0] + (top[1] - top[0]) * fx;
+  value = static_cast<float>(lower + (upper - lower) * fy);
+  return true;
+}
+
+void KeyframeSequence::Interpolate(const FloatExp &radius, IterationBuffer &frame) const {
+  // Keyframe k covers every view from its own radius in to half of it
+  double octaves = std::clamp((Log(start_radius_) - Log(radius)) / std::numbers::ln2, 0.0, static_cast<double>(keyframes_ - 1));
+  int k = std::min(static_cast<int>(octaves), keyframes_ - 1);
+  double blend = octaves - k;
+  // The frame relative to keyframes k and k + 1
+  double scale = std::exp2(-blend), next_scale = 2 * scale;
+
+  int keyframe_width = width_ * kOversize, keyframe_height = height_ * kOversize;
+  for (int y = 0; y < frame.height; y++) {
+    for (int x = 0; x < frame.width; x++) {
+      double u, v, keyframe_x, keyframe_y;
+      PixelToCanvas(x, y, frame.width, frame.height, u, v);
+      CanvasToPixel(0.5 + (u - 0.5) * scale, 0.5 + (v - 0.5) * scale, keyframe_width, keyframe_height, keyframe_x, keyframe_y);
+      float value = kInterior, next;
+      Sample(k, keyframe_x, keyframe_y, value);
+
+      CanvasToPixel(0.5 + (u - 0.5) * next_scale, 0.5 + (v - 0.5) * next_scale, keyframe_width, keyframe_height, keyframe_x, keyframe_y);
+      if (blend > 0.0 && k + 1 < keyframes_ && Sample(k + 1, keyframe_x, keyframe_y, next)) {
+        if (std::isinf(value) || std::isinf(next))
+          value = blend < 0.5 ? value : next;
+        else
+          value = static_cast<float>(value + (next - value) * blend);
+      }
+      frame.At(x, y) = value;
+    }
+  }
+}
+
+bool KeyframeSequence::Save(const std::string &path) const {
+  std::ofstream out(path, std::ios::binary);
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.keyframes = keyframes_;
+  header.width = width_;
+  header.height = height_;
+  header.start_mantissa = start_radius_.mantissa();
+  header.start_exponent = start_radius_.exponent();
+  header.max_it = max_it_;
+  // Every limb takes 32 decimal digits to write out exactly
+  int digits = 32 * center_.fraction_limbs();
+  std::string center = center_.re.ToString(digits) + "," + center_.im.ToString(digits);
+  header.center_fraction_limbs = center_.fraction_limbs();
+  header.center_length = static_cast<int32_t>(center.size());
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out.write(center.data(), static_cast<std::streamsize>(center.size()));
+  out.write(reinterpret_cast<const char *>(samples_.data()), static_cast<std::streamsize>(samples_.size() * sizeof(float)));
+  return static_cast<bool>(out);
+}
+
+std::optional<KeyframeSequence> KeyframeSequence::Load(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  Header header;
+  if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+    return std::nullopt;
+  if (header.keyframes <= 0 || header.width <= 0 || header.height <= 0 || header.center_fraction_limbs < 0 || header.center_length <= 0)
+    return std::nullopt;
+
+  std::string center(header.center_length, '\0');
+  if (!in.read(center.data(), header.center_length))
+    return std::nullopt;
+  size_t comma = center.find(',');
+  std::optional<FixedComplex> parsed;
+  if (comma != std::string::npos)
+    parsed = FixedComplex::Parse(std::string_view(center).substr(0, comma), std::string_view(center).substr(comma + 1), header.center_fraction_limbs);
+  if (!parsed)
+    return std::nullopt;
+
+  KeyframeSequence sequence;
+  sequence.center_ = *parsed;
+  sequence.keyframes_ = header.keyframes;
+  sequence.width_ = header.width;
+  sequence.height_ = header.height;
+  sequence.start_radius_ = FloatExp(header.start_mantissa, header.start_exponent);
+  sequence.max_it_ = header.max_it;
+  sequence.samples_.resize(static_cast<size_t>(sequence.width_) * kOversize * sequence.height_ * kOversize * sequence.keyframes_);
+  if (!in.read(reinterpret_cast<char *>(sequence.samples_.data()), static_cast<std::streamsize>(sequence.samples_.size() * sizeof(float))))
+    return std::nullopt;
+  return sequence;
+}
+
+};  // namespace mandelbrot
@@ -0,0 +1,84 @@
+#ifndef MANDELBROT_CORE_KEYFRAMES_H_
+#define MANDELBROT_CORE_KEYFRAMES_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "mandelbrot-core/fixed_point.h"
+#include "mandelbrot-core/float_exp.h"
+#include "mandelbrot-core/perturbation.h"
+#include "mandelbrot-core/renderer.h"
+#include "mandelbrot-core/scheduler.h"
+
+namespace mandelbrot {
+
+// A zoom toward `center` of frames `width` x `height`, from the view of
+// half-height `start_radius` in by `keyframes` - 1 halvings of it.
+struct KeyframeParams {
+  FixedComplex center;
+  FloatExp start_radius;
+  int keyframes;
+  int width;
+  int height;
+  float max_it;
+};
+
+struct KeyframeStats {
+  double render_seconds;     // Spent rendering every keyframe
+  double reference_seconds;  // Of which on the reference orbit
+  long pixels;               // Pixels rendered, over all keyframes
+};
+
+// Iteration counts of a zoom rendered once per halving of the view: keyframe
+// k has half-height start_radius 2^-k and kOversize times the resolution of
+// a frame, so every frame between keyframes k and k + 1 is a crop of
+// keyframe k at no less than its own resolution. Frames are resampled from
+// the two keyframes around them, blending into the next one on the way, so
+// the details of the deeper keyframe fade in instead of popping up.
+class KeyframeSequence {
+ public:
+  // Keyframe pixels per frame pixel, along each side
+  static constexpr int kOversize = 2;
+
+  // Renders the keyframes by perturbation, from the destination outward:
+  // all of them share the reference orbit of the deepest.
+  KeyframeStats Render(const KeyframeParams &params, TileScheduler &scheduler);
+
+  // Fills `frame`, of the size of the sequence, with the view of
+  // half-height `radius`, which is clamped to the keyframes.
+  void Interpolate(const FloatExp &radius, IterationBuffer &frame) const;
+
+  // Writes the keyframes to `path` in a raw binary format with the byte
+  // order of the host; false if it could not be written
+  bool Save(const std::string &path) const;
+  // Reads keyframes written by Save(), if `path` holds them
+  static std::optional<KeyframeSequence> Load(const std::string &path);
+
+  const FixedComplex &center() const { return center_; }
+  int keyframes() const { return keyframes_; }
+  int width() const { return width_; }
+  int height() const { return height_; }
+  const FloatExp &start_radius() const { return start_radius_; }
+  float max_it() const { return max_it_; }
+
+  // Half-height of keyframe k
+  FloatExp Radius(int k) const { return Ldexp(start_radius_, -k); }
+
+ private:
+  // Keyframe k at pixel (x, y) of it, interpolated bilinearly, or nearest
+  // next to interior pixels; false past its edges
+  bool Sample(int k, double x, double y, float &value) const;
+
+  FixedComplex center_;
+  int keyframes_ = 0;
+  int width_ = 0;
+  int height_ = 0;
+  FloatExp start_radius_;
+  float max_it_ = 0.0f;
+  std::vector<float> samples_;
+};
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_KEYFRAMES_H_
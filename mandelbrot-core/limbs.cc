@@ -0,0 +1,350 @@
+#include "mandelbrot-core/limbs.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "mandelbrot-core/task_pool.h"
+
+namespace mandelbrot {
+
+namespace limbs {
+
+namespace {
+
+using Limbs = std::vector<uint32_t>;
+using View = std::span<const uint32_t>;
+
+Limbs Schoolbook(View a, View b) {
+  Limbs out(a.size() + b.size(), 0);
+  for (size_t i = 0; i < a.size(); i++) {
+    uint64_t carry = 0;
+    for (size_t j = 0; j < b.size(); j++) {
+      uint64_t t = static_cast<uint64_t>(a[i]) * b[j] + out[i + j] + carry;
+      out[i + j] = static_cast<uint32_t>(t);
+      carry = t >> 32;
+    }
+    out[i + b.size()] = static_cast<uint32_t>(carry);
+  }
+  return out;
+}
+
+Limbs SchoolbookSquare(View a) {
+  // Every a_i a_j with i < j once, doubled, plus the squares a_i^2
+  size_t n = a.size();
+  Limbs out(2 * n, 0);
+  for (size_t i = 0; i < n; i++) {
+    uint64_t carry = 0;
+    for (size_t j = i + 1; j < n; j++) {
+      uint64_t t = static_cast<uint64_t>(a[i]) * a[j] + out[i + j] + carry;
+      out[i + j] = static_cast<uint32_t>(t);
+      carry = t >> 32;
+    }
+    out[i + n] = static_cast<uint32_t>(carry);
+  }
+  uint32_t shifted = 0;
+  for (uint32_t &limb : out) {
+    uint32_t next = limb >> 31;
+    limb = limb << 1 | shifted;
+    shifted = next;
+  }
+  uint64_t carry = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint64_t t = static_cast<uint64_t>(a[i]) * a[i] + out[2 * i] + carry;
+    out[2 * i] = static_cast<uint32_t>(t);
+    t = (t >> 32) + out[2 * i + 1];
+    out[2 * i + 1] = static_cast<uint32_t>(t);
+    carry = t >> 32;
+  }
+  return out;
+}
+
+// out += x 2^(32 shift); limbs of x past the end of out must be zero
+void AddAt(Limbs &out, View x, size_t shift) {
+  uint64_t carry = 0;
+  size_t i = shift;
+  for (size_t k = 0; k < x.size() && i < out.size(); k++, i++) {
+    uint64_t t = static_cast<uint64_t>(out[i]) + x[k] + carry;
+    out[i] = static_cast<uint32_t>(t);
+    carry = t >> 32;
+  }
+  for (; carry && i < out.size(); i++) {
+    uint64_t t = static_cast<uint64_t>(out[i]) + carry;
+    out[i] = static_cast<uint32_t>(t);
+    carry = t >> 32;
+  }
+}
+
+// out -= x, with out >= x
+void Subtract(Limbs &out, View x) {
+  int64_t borrow = 0;
+  size_t i = 0;
+  for (; i < x.size(); i++) {
+    int64_t t = static_cast<int64_t>(out[i]) - x[i] - borrow;
+    borrow = t < 0;
+    out[i] = static_cast<uint32_t>(t + (borrow << 32));
+  }
+  for (; borrow && i < out.size(); i++) {
+    borrow = out[i] == 0;
+    out[i]--;
+  }
+}
+
+Limbs Sum(View low, View high) {
+  Limbs out(std::max(low.size(), high.size()) + 1, 0);
+  AddAt(out, low, 0);
+  AddAt(out, high, 0);
+  return out;
+}
+
+Limbs Karatsuba(View a, View b, bool square) {
+  if (a.size() < b.size())
+    std::swap(a, b);
+  size_t n = a.size(), m = b.size();
+  if (m < kKaratsubaThreshold)
+    return square ? SchoolbookSquare(a) : Schoolbook(a, b);
+
+  if (n != m) {
+    // Unbalanced: multiply b by each m-limb slice of a
+    Limbs out(n + m, 0);
+    for (size_t shift = 0; shift < n; shift += m)
+      AddAt(out, Karatsuba(a.subspan(shift, std::min(m, n - shift)), b, false), shift);
+    return out;
+  }
+
+  // a b = z2 2^(64 h) + z1 2^(32 h) + z0, with z1 from the one product
+  // (a0 + a1)(b0 + b1) - z0 - z2
+  size_t h = n / 2;
+  View a0 = a.first(h), a1 = a.subspan(h), b0 = b.first(h), b1 = b.subspan(h);
+  Limbs sa = Sum(a0, a1), sb = square ? Limbs() : Sum(b0, b1);
+  Limbs z0, z1, z2;
+  auto product = [&](int i) {
+    if (i == 0)
+      z0 = Karatsuba(a0, b0, square);
+    else if (i == 1)
+      z2 = Karatsuba(a1, b1, square);
+    else
+      z1 = square ? Karatsuba(sa, sa, true) : Karatsuba(sa, sb, false);
+  };
+  if (m >= kParallelThreshold) {
+    TaskPool::Shared().Run(3, product);
+  } else {
+    for (int i = 0; i < 3; i++)
+      product(i);
+  }
+  Subtract(z1, z0);
+  Subtract(z1, z2);
+
+  Limbs out(2 * n, 0);
+  AddAt(out, z0, 0);
+  AddAt(out, z2, 2 * h);
+  AddAt(out, z1, h);
+  return out;
+}
+
+// Arithmetic mod a prime P = k 2^s + 1 < 2^31 with generator G, for
+// transforms of up to 2^s points. The transforms multiply in Montgomery
+// form, a b 2^-32 mod P, which needs no division.
+template <uint32_t P, uint32_t G>
+struct Field {
+  static constexpr uint32_t kMontgomeryOne = static_cast<uint32_t>((uint64_t{1} << 32) % P);
+
+  // -1 / P mod 2^32, by Newton's iteration
+  static constexpr uint32_t NegativeInverse() {
+    uint32_t inverse = P;
+    for (int i = 0; i < 5; i++)
+      inverse *= 2 - P * inverse;
+    return -inverse;
+  }
+  static constexpr uint32_t kNegativeInverse = NegativeInverse();
+
+  static uint32_t Multiply(uint32_t a, uint32_t b) { return static_cast<uint32_t>(static_cast<uint64_t>(a) * b % P); }
+
+  static uint32_t Montgomery(uint32_t a, uint32_t b) {
+    uint64_t t = static_cast<uint64_t>(a) * b;
+    uint32_t m = static_cast<uint32_t>(t) * kNegativeInverse;
+    uint32_t u = static_cast<uint32_t>((t + static_cast<uint64_t>(m) * P) >> 32);
+    return u >= P ? u - P : u;
+  }
+
+  static uint32_t Power(uint32_t base, uint64_t exponent) {
+    uint32_t out = 1;
+    for (; exponent; exponent >>= 1) {
+      if (exponent & 1)
+        out = Multiply(out, base);
+      base = Multiply(base, base);
+    }
+    return out;
+  }
+
+  // In-place radix-2 transform, or its inverse without the 1/n. The forward
+  // transform leaves its points in bit-reversed order, which is the order
+  // the inverse one takes them in, so neither has to permute them.
+  static void Transform(Limbs &x, bool inverse) {
+    size_t n = x.size();
+
+    // Roots in Montgomery form, so multiplying by them leaves x as it is.
+    // roots[half + k] is the k-th power of the length 2 half root of unity;
+    // every stage takes every other root of the next one, so only the last
+    // is a chain of products.
+    Limbs roots(std::max<size_t>(n, 2));
+    uint32_t root = Power(G, (P - 1) / n);
+    if (inverse)
+      root = Power(root, P - 2);
+    root = Multiply(root, kMontgomeryOne);
+    roots[n / 2] = kMontgomeryOne;
+    for (size_t k = n / 2 + 1; k < n; k++)
+      roots[k] = Montgomery(roots[k - 1], root);
+    for (size_t half = n / 4; half >= 1; half /= 2) {
+      for (size_t k = 0; k < half; k++)
+        roots[half + k] = roots[2 * (half + k)];
+    }
+
+    // Butterflies on plain pointers, which the compiler vectorizes
+    if (!inverse) {
+      for (size_t half = n / 2; half >= 1; half /= 2) {
+        const uint32_t *w = roots.data() + half;
+        for (size_t i = 0; i < n; i += 2 * half) {
+          uint32_t *low = x.data() + i, *high = low + half;
+          for (size_t k = 0; k < half; k++) {
+            uint32_t u = low[k], v = high[k];
+            uint32_t sum = u + v, difference = u - v;
+            low[k] = sum >= P ? sum - P : sum;
+            high[k] = Montgomery(u >= v ? difference : difference + P, w[k]);
+          }
+        }
+      }
+    } else {
+      for (size_t half = 1; half < n; half *= 2) {
+        const uint32_t *w = roots.data() + half;
+        for (size_t i = 0; i < n; i += 2 * half) {
+          uint32_t *low = x.data() + i, *high = low + half;
+          for (size_t k = 0; k < half; k++) {
+            uint32_t u = low[k], v = Montgomery(high[k], w[k]);
+            uint32_t sum = u + v, difference = u - v;
+            low[k] = sum >= P ? sum - P : sum;
+            high[k] = u >= v ? difference : difference + P;
+          }
+        }
+      }
+    }
+  }
+
+  // Cyclic convolution of a and b, zero-padded to `points`, mod P
+  static Limbs Convolve(const Limbs &a, const Limbs &b, size_t points, bool square) {
+    Limbs fa = a;
+    fa.resize(points, 0);
+    Transform(fa, false);
+    if (square) {
+      for (uint32_t &value : fa)
+        value = Montgomery(value, value);
+    } else {
+      Limbs fb = b;
+      fb.resize(points, 0);
+      Transform(fb, false);
+      for (size_t i = 0; i < points; i++)
+        fa[i] = Montgomery(fa[i], fb[i]);
+    }
+    Transform(fa, true);
+
+    // 2^32 / n undoes both the 2^-32 of the products and the n of the
+    // inverse transform
+    uint32_t scale = Multiply(Power(static_cast<uint32_t>(points % P), P - 2), Multiply(kMontgomeryOne, kMontgomeryOne));
+    for (uint32_t &value : fa)
+      value = Montgomery(value, scale);
+    return fa;
+  }
+};
+
+// Two primes whose product, near 2^61, exceeds every convolution of 16-bit
+// digits up to 2^23 points
+using Field1 = Field<998244353, 3>;
+using Field2 = Field<2013265921, 31>;
+
+// The convolution is done on 16-bit digits so the coefficients stay below
+// the product of the primes
+Limbs Digits(View a) {
+  Limbs out(2 * a.size());
+  for (size_t i = 0; i < a.size(); i++) {
+    out[2 * i] = a[i] & 0xffff;
+    out[2 * i + 1] = a[i] >> 16;
+  }
+  return out;
+}
+
+Limbs Ntt(View a, View b, bool square) {
+  Limbs da = Digits(a), db = square ? Limbs() : Digits(b);
+  size_t points = std::bit_ceil(2 * (a.size() + b.size()));
+
+  Limbs r1, r2;
+  auto convolve = [&](int i) {
+    if (i == 0)
+      r1 = Field1::Convolve(da, db, points, square);
+    else
+      r2 = Field2::Convolve(da, db, points, square);
+  };
+  if (std::min(a.size(), b.size()) >= kParallelThreshold) {
+    TaskPool::Shared().Run(2, convolve);
+  } else {
+    convolve(0);
+    convolve(1);
+  }
+
+  // Chinese remainders: x = r1 + p1 ((r2 - r1) / p1 mod p2), then carries
+  constexpr uint64_t kP1 = 998244353, kP2 = 2013265921;
+  // 1 / p1 mod p2 times 2^32, so a Montgomery product divides by p1
+  static const uint32_t kInverse = Field2::Multiply(Field2::Power(kP1, kP2 - 2), Field2::kMontgomeryOne);
+  Limbs out(a.size() + b.size(), 0);
+  uint64_t carry = 0;
+  for (size_t i = 0; i < 2 * out.size(); i++) {
+    // r1 < p1 < p2
+    uint32_t difference = r2[i] >= r1[i] ? r2[i] - r1[i] : r2[i] + static_cast<uint32_t>(kP2) - r1[i];
+    uint64_t x = r1[i] + kP1 * Field2::Montgomery(difference, kInverse);
+    carry += x;
+    out[i / 2] |= static_cast<uint32_t>(carry & 0xffff) << (16 * (i % 2));
+    carry >>= 16;
+  }
+  return out;
+}
+
+Limbs Product(View a, View b, bool square, Algorithm algorithm) {
+  if (a.empty() || b.empty())
+    return Limbs(a.size() + b.size(), 0);
+  switch (algorithm) {
+    case Algorithm::kSchoolbook:
+      return square ? SchoolbookSquare(a) : Schoolbook(a, b);
+    case Algorithm::kKaratsuba:
+      return Karatsuba(a, b, square);
+    case Algorithm::kNtt:
+      return Ntt(a, b, square);
+  }
+  return {};
+}
+
+};  // namespace
+
+Algorithm AlgorithmFor(size_t n, size_t m) {
+  size_t shorter = std::min(n, m);
+  if (shorter >= kNttThreshold)
+    return Algorithm::kNtt;
+  return shorter >= kKaratsubaThreshold ? Algorithm::kKaratsuba : Algorithm::kSchoolbook;
+}
+
+std::vector<uint32_t> Multiply(std::span<const uint32_t> a, std::span<const uint32_t> b) {
+  return Multiply(a, b, AlgorithmFor(a.size(), b.size()));
+}
+
+std::vector<uint32_t> Multiply(std::span<const uint32_t> a, std::span<const uint32_t> b, Algorithm algorithm) {
+  return Product(a, b, false, algorithm);
+}
+
+std::vector<uint32_t> Square(std::span<const uint32_t> a) {
+  return Square(a, AlgorithmFor(a.size(), a.size()));
+}
+
+std::vector<uint32_t> Square(std::span<const uint32_t> a, Algorithm algorithm) {
+  return Product(a, a, true, algorithm);
+}
+
+};  // namespace limbs
+
+};  // namespace mandelbrot
@@ -0,0 +1,48 @@
+#ifndef MANDELBROT_CORE_LIMBS_H_
+#define MANDELBROT_CORE_LIMBS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace mandelbrot {
+
+namespace limbs {
+
+// Products of naturals held as 32-bit limbs, least significant first. All
+// algorithms return the exact n + m limb product, so they agree bit for bit
+// and only differ in speed.
+enum class Algorithm {
+  kSchoolbook,  // O(n m), the fastest for a few dozen limbs
+  kKaratsuba,   // O(n^1.58), splitting both operands in halves
+  kNtt,         // O(n log n), number-theoretic transforms mod two primes
+};
+
+// Operand sizes, in limbs of the shorter operand, from which the faster
+// algorithms pay off, as mandelbrot-benchmark measures them on one thread.
+// The transforms round up to powers of two, so an NTT costs the same from
+// just past one up to the next while Karatsuba keeps growing: the NTT
+// overtakes it at about 3000 limbs (96k bits), falls back level just past
+// 4096 and pulls ahead for good by about 6000.
+inline constexpr size_t kKaratsubaThreshold = 48;
+inline constexpr size_t kNttThreshold = 3000;
+
+// Limbs from which independent products are worth running on
+// TaskPool::Shared()
+inline constexpr size_t kParallelThreshold = 512;
+
+Algorithm AlgorithmFor(size_t n, size_t m);
+
+std::vector<uint32_t> Multiply(std::span<const uint32_t> a, std::span<const uint32_t> b);
+std::vector<uint32_t> Multiply(std::span<const uint32_t> a, std::span<const uint32_t> b, Algorithm algorithm);
+
+// Multiply(a, a), which every algorithm does with less work
+std::vector<uint32_t> Square(std::span<const uint32_t> a);
+std::vector<uint32_t> Square(std::span<const uint32_t> a, Algorithm algorithm);
+
+};  // namespace limbs
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_LIMBS_H_
@@ -0,0 +1,434 @@
+#include "mandelbrot-core/perturbation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+#include "mandelbrot-core/bla.h"
+#include "mandelbrot-core/escape_time.h"
+#include "mandelbrot-core/series.h"
+#include "mandelbrot-core/tile.h"
+
+namespace mandelbrot {
+
+ReferenceOrbit::ReferenceOrbit(const FixedComplex &c)
+    : c_(c), z_{FixedPoint(0.0, c.fraction_limbs()), FixedPoint(0.0, c.fraction_limbs())} {}
+
+void ReferenceOrbit::Extend(int max_iterations) {
+  while (!escaped_ && static_cast<int>(points_.size()) <= max_iterations) {
+    z_ = z_.Square() + c_;
+
+    Complex z = z_.ToComplex();
+    points_.push_back(z);
+    escaped_ = z.re * z.re + z.im * z.im > kBailout;
+  }
+}
+
+Escape PerturbedEscapeTime(const ReferenceOrbit &reference, Complex dc, int skip, Complex delta, int max_iterations, double glitch_tolerance, bool &glitched) {
+  const std::vector<Complex> &orbit = reference.points();
+  int last = static_cast<int>(orbit.size()) - 1;
+  double tolerance2 = glitch_tolerance * glitch_tolerance;
+
+  double dx = delta.re, dy = delta.im;
+  double zx = orbit[skip].re + dx, zy = orbit[skip].im + dy;
+  double norm = zx * zx + zy * zy;
+
+  int it = skip;
+  for (; it < max_iterations && norm <= kBailout; it++) {
+    if (it == last) {
+      // The reference escaped first
+      if (glitch_tolerance > 0) {
+        glitched = true;
+        break;
+      }
+      // z is far from the point by now, so carry on without it
+      Complex c = reference.c().ToComplex();
+      c = {c.re + dc.re, c.im + dc.im};
+      for (; it < max_iterations && norm <= kBailout; it++) {
+        double x = zx;
+        zx = zx * zx - zy * zy + c.re;
+        zy = 2 * x * zy + c.im;
+        norm = zx * zx + zy * zy;
+      }
+      break;
+    }
+
+    const Complex &z = orbit[it];
+    double next_dx = 2 * (z.re * dx - z.im * dy) + (dx * dx - dy * dy) + dc.re;
+    double next_dy = 2 * (z.re * dy + z.im * dx) + 2 * dx * dy + dc.im;
+    dx = next_dx;
+    dy = next_dy;
+
+    const Complex &next = orbit[it + 1];
+    zx = next.re + dx;
+    zy = next.im + dy;
+    norm = zx * zx + zy * zy;
+
+    if (norm < tolerance2 * (next.re * next.re + next.im * next.im)) {
+      glitched = true;
+      break;
+    }
+  }
+  return {it, norm};
+}
+
+namespace {
+
+// The loop of RebasedEscapeTime(), picking the pixel up at iteration `it`
+// and point `m` of the orbit with delta (dx, dy)
+Escape Rebased(const std::vector<Complex> &orbit, const BlaTable *bla, Complex dc, int it, int m, double dx, double dy, int max_iterations, RebaseCounters &counters) {
+  int last = static_cast<int>(orbit.size()) - 1;
+
+  double zx = orbit[m].re + dx, zy = orbit[m].im + dy;
+  double norm = zx * zx + zy * zy;
+
+  while (it < max_iterations && norm <= kBailout) {
+    const BlaStep *step = bla ? bla->Lookup(m, dx * dx + dy * dy, max_iterations - it) : nullptr;
+    if (step) {
+      double next_dx = (step->a.re * dx - step->a.im * dy) + (step->b.re * dc.re - step->b.im * dc.im);
+      double next_dy = (step->a.re * dy + step->a.im * dx) + (step->b.re * dc.im + step->b.im * dc.re);
+      dx = next_dx;
+      dy = next_dy;
+      m += step->length;
+      it += step->length;
+    } else {
+      const Complex &z = orbit[m];
+      double next_dx = 2 * (z.re * dx - z.im * dy) + (dx * dx - dy * dy) + dc.re;
+      double next_dy = 2 * (z.re * dy + z.im * dx) + 2 * dx * dy + dc.im;
+      dx = next_dx;
+      dy = next_dy;
+      m++;
+      it++;
+    }
+    counters.steps++;
+
+    const Complex &next = orbit[m];
+    zx = next.re + dx;
+    zy = next.im + dy;
+    norm = zx * zx + zy * zy;
+
+    if (m == last || norm < dx * dx + dy * dy) {
+      dx = zx;
+      dy = zy;
+      m = 0;
+      counters.rebases++;
+    }
+  }
+  return {it, norm};
+}
+
+};  // namespace
+
+Escape RebasedEscapeTime(const ReferenceOrbit &reference, const BlaTable *bla, Complex dc, int skip, Complex delta, int max_iterations, RebaseCounters &counters) {
+  // `m` walks the reference orbit, `it` counts the pixel's iterations
+  return Rebased(reference.points(), bla, dc, skip, skip, delta.re, delta.im, max_iterations, counters);
+}
+
+Escape RebasedEscapeTime(const ReferenceOrbit &reference, const ExpBlaTable *exp_bla, const BlaTable *bla, ExpComplex dc, int max_iterations, RebaseCounters &counters) {
+  const std::vector<Complex> &orbit = reference.points();
+  int last = static_cast<int>(orbit.size()) - 1;
+
+  ExpComplex delta;
+  int it = 0, m = 0;
+  while (it < max_iterations && delta.exponent() < kFloatExpDeltaExponent) {
+    const ExpBlaStep *step = exp_bla ? exp_bla->Lookup(m, delta.Norm(), max_iterations - it) : nullptr;
+    if (step) {
+      delta = step->a * delta + step->b * dc;
+      m += step->length;
+      it += step->length;
+    } else {
+      const Complex &z = orbit[m];
+      delta = Complex{2 * z.re, 2 * z.im} * delta + delta * delta + dc;
+      m++;
+      it++;
+    }
+    counters.steps++;
+
+    // z_n itself is never out of range of a double, only d_n
+    Complex d = delta.ToComplex();
+    Complex z = {orbit[m].re + d.re, orbit[m].im + d.im};
+    double norm = z.re * z.re + z.im * z.im;
+    if (norm > kBailout)
+      return {it, norm};
+    if (m == last || FloatExp(norm) < delta.Norm()) {
+      delta = z;
+      m = 0;
+      counters.rebases++;
+    }
+  }
+
+  // The delta is within range of a double now, and dc negligible next to
+  // it if it underflows
+  Complex d = delta.ToComplex();
+  return Rebased(orbit, bla, dc.ToComplex(), it, m, d.re, d.im, max_iterations, counters);
+}
+
+namespace {
+
+// Finds the largest 4-connected blob of glitched pixels and returns the
+// pixel of the blob closest to its centroid.
+bool FindGlitchCenter(const std::vector<unsigned char> &glitched, int width, int height, int &center_x, int &center_y) {
+  std::vector<unsigned char> visited(glitched.size(), 0);
+  std::vector<int> blob, largest, stack;
+
+  for (int start = 0; start < static_cast<int>(glitched.size()); start++) {
+    if (!glitched[start] || visited[start])
+      continue;
+
+    blob.clear();
+    stack.assign(1, start);
+    visited[start] = 1;
+    while (!stack.empty()) {
+      int i = stack.back();
+      stack.pop_back();
+      blob.push_back(i);
+
+      int x = i % width, y = i / width;
+      int neighbours[4][2] = {{x - 1, y}, {x + 1, y}, {x, y - 1}, {x, y + 1}};
+      for (const auto &[nx, ny] : neighbours) {
+        if (nx < 0 || ny < 0 || nx >= width || ny >= height)
+          continue;
+        int n = ny * width + nx;
+        if (glitched[n] && !visited[n]) {
+          visited[n] = 1;
+          stack.push_back(n);
+        }
+      }
+    }
+    if (blob.size() > largest.size())
+      largest.swap(blob);
+  }
+  if (largest.empty())
+    return false;
+
+  double mean_x = 0.0, mean_y = 0.0;
+  for (int i : largest) {
+    mean_x += i % width;
+    mean_y += i / width;
+  }
+  mean_x /= largest.size();
+  mean_y /= largest.size();
+
+  // Blobs need not be convex, so take a member rather than the centroid
+  double best = -1.0;
+  for (int i : largest) {
+    double dx = i % width - mean_x, dy = i / width - mean_y;
+    if (best < 0 || dx * dx + dy * dy < best) {
+      best = dx * dx + dy * dy;
+      center_x = i % width;
+      center_y = i / width;
+    }
+  }
+  return true;
+}
+
+};  // namespace
+
+// What the series and BLA tables were built for, and the tables
+struct PerturbationRenderer::Tables {
+  DeepViewport lbrt;
+  int max_iterations = 0;
+  int series_terms = 0;
+  bool bla = false;
+  size_t reference_length = 0;
+
+  SeriesApproximation series;
+  BlaTable bla_table;
+  ExpBlaTable exp_bla_table;
+};
+
+PerturbationStats PerturbationRenderer::Render(const PerturbationParams &params, IterationBuffer &buffer, TileScheduler &scheduler) {
+  using Clock = std::chrono::steady_clock;
+  int max_iterations = MaxIterations(params.max_it);
+  PerturbationStats stats{};
+
+  // Precision is part of the point: a deeper view needs a new orbit
+  auto start = Clock::now();
+  if (!(reference_.c() == params.lbrt.center))
+    reference_ = ReferenceOrbit(params.lbrt.center);
+  reference_.Extend(max_iterations);
+  stats.reference_length = static_cast<int>(reference_.points().size());
+  auto referenced = Clock::now();
+  stats.reference_seconds += std::chrono::duration<double>(referenced - start).count();
+
+  // The offsets of the view at their true scale, unless they are too small
+  // for doubles: then the pixels are iterated in FloatExp
+  const Viewport &scaled = params.lbrt.offset;
+  FloatExp dc_radius;
+  for (Complex corner : {Complex{scaled.left, scaled.bottom}, Complex{scaled.right, scaled.bottom}, Complex{scaled.left, scaled.top}, Complex{scaled.right, scaled.top}}) {
+    FloatExp radius = Ldexp(FloatExp(std::hypot(corner.re, corner.im)), params.lbrt.offset_exponent);
+    if (dc_radius < radius)
+      dc_radius = radius;
+  }
+  stats.float_exp = dc_radius < FloatExp(kFloatExpRadiusLimit);
+  int exponent = static_cast<int>(std::clamp<int64_t>(params.lbrt.offset_exponent, -4096, 4096));
+  Viewport offset = {
+      std::ldexp(scaled.left, exponent),
+      std::ldexp(scaled.bottom, exponent),
+      std::ldexp(scaled.right, exponent),
+      std::ldexp(scaled.top, exponent),
+  };
+
+  // Every pixel of the main reference starts where the series gives out,
+  // which it never does in FloatExp. The series and BLA tables are only
+  // built for a view they were not already built for.
+  bool bla = (params.rebase || stats.float_exp) && params.bla;
+  size_t reference_length = reference_.points().size();
+  if (!tables_ || tables_->lbrt != params.lbrt || tables_->max_iterations != max_iterations || tables_->series_terms != params.series_terms || tables_->bla != bla || tables_->reference_length != reference_length) {
+    tables_ = std::make_shared<Tables>();
+    tables_->lbrt = params.lbrt;
+    tables_->max_iterations = max_iterations;
+    tables_->series_terms = params.series_terms;
+    tables_->bla = bla;
+    tables_->reference_length = reference_length;
+    if (!stats.float_exp)
+      tables_->series = SeriesApproximation(reference_, offset, params.series_terms, max_iterations);
+    auto fitted = Clock::now();
+    stats.series_seconds = std::chrono::duration<double>(fitted - referenced).count();
+
+    if (bla) {
+      tables_->bla_table = BlaTable(reference_, dc_radius.ToDouble());
+      if (stats.float_exp)
+        tables_->exp_bla_table = ExpBlaTable(reference_, dc_radius);
+    }
+    stats.bla_seconds = std::chrono::duration<double>(Clock::now() - fitted).count();
+  }
+  const SeriesApproximation &series = tables_->series;
+  stats.series_skip = series.skip();
+  long pixels = static_cast<long>(buffer.width) * buffer.height;
+  if (params.mask)
+    pixels = std::count_if(params.mask, params.mask + pixels, [](unsigned char masked) { return masked != 0; });
+
+  // The skipped iterations would have cost as much as the ones iterated
+  auto estimate_saved = [&](long long iterated, double seconds) {
+    if (iterated > 0)
+      stats.saved_seconds = seconds * static_cast<double>(series.skip()) * pixels / iterated - stats.series_seconds;
+  };
+
+  std::vector<Tile> tiles = SplitIntoTiles(buffer.width, buffer.height, params.tile_size);
+
+  if (params.rebase || stats.float_exp) {
+    const BlaTable &bla_table = tables_->bla_table;
+    const ExpBlaTable &exp_bla_table = tables_->exp_bla_table;
+    stats.bla_bytes = bla_table.bytes() + exp_bla_table.bytes();
+    auto built = Clock::now();
+
+    std::atomic<long> rebases = 0;
+    std::atomic<long long> iterated = 0, steps = 0;
+    scheduler.Run(tiles, [&](const Tile &tile) {
+      RebaseCounters counters;
+      long long tile_iterated = 0;
+      for (int y = tile.y; y < tile.y + tile.height; y++) {
+        for (int x = tile.x; x < tile.x + tile.width; x++) {
+          if (params.mask && !params.mask[static_cast<size_t>(y) * buffer.width + x])
+            continue;
+
+          double u, v;
+          PixelToCanvas(x, y, buffer.width, buffer.height, u, v);
+          Escape escape;
+          if (stats.float_exp) {
+            ExpComplex dc(scaled.At(u, v), params.lbrt.offset_exponent);
+            escape = RebasedEscapeTime(reference_, bla ? &exp_bla_table : nullptr, bla ? &bla_table : nullptr, dc, max_iterations, counters);
+          } else {
+            Complex dc = offset.At(u, v);
+            escape = RebasedEscapeTime(reference_, bla ? &bla_table : nullptr, dc, series.skip(), series.Delta(dc), max_iterations, counters);
+          }
+          buffer.At(x, y) = SmoothIteration(escape, max_iterations);
+          tile_iterated += escape.iterations - series.skip();
+        }
+      }
+      rebases += counters.rebases;
+      steps += counters.steps;
+      iterated += tile_iterated;
+    });
+    stats.passes = 1;
+    stats.rebases = rebases;
+    stats.render_seconds = std::chrono::duration<double>(Clock::now() - built).count();
+    stats.bla_speedup = steps > 0 ? static_cast<double>(iterated) / steps : 1.0;
+    estimate_saved(steps, stats.render_seconds);
+    return stats;
+  }
+
+  if (params.mask)
+    glitched_.assign(params.mask, params.mask + static_cast<size_t>(buffer.width) * buffer.height);
+  else
+    glitched_.assign(static_cast<size_t>(buffer.width) * buffer.height, 1);
+
+  // Iterates the glitched pixels against `reference`, whose point sits at
+  // `origin` in the offsets of the viewport, picking it up where `series`
+  // gives out; returns the number of glitched pixels
+  std::atomic<long long> iterated = 0;
+  auto iterate = [&](const ReferenceOrbit &reference, const SeriesApproximation &series, Complex origin, double glitch_tolerance) {
+    std::atomic<long> glitched = 0;
+    iterated = 0;
+    scheduler.Run(tiles, [&](const Tile &tile) {
+      long tile_glitched = 0;
+      long long tile_iterated = 0;
+      for (int y = tile.y; y < tile.y + tile.height; y++) {
+        for (int x = tile.x; x < tile.x + tile.width; x++) {
+          unsigned char &pixel_glitched = glitched_[static_cast<size_t>(y) * buffer.width + x];
+          if (!pixel_glitched)
+            continue;
+
+          double u, v;
+          PixelToCanvas(x, y, buffer.width, buffer.height, u, v);
+          Complex at = offset.At(u, v);
+          Complex dc = {at.re - origin.re, at.im - origin.im};
+          bool glitch = false;
+          Escape escape = PerturbedEscapeTime(reference, dc, series.skip(), series.Delta(dc), max_iterations, glitch_tolerance, glitch);
+          buffer.At(x, y) = SmoothIteration(escape, max_iterations);
+          pixel_glitched = glitch;
+          tile_glitched += glitch;
+          tile_iterated += escape.iterations - series.skip();
+        }
+      }
+      glitched += tile_glitched;
+      iterated += tile_iterated;
+    });
+    return glitched.load();
+  };
+
+  start = Clock::now();
+  stats.passes = 1;
+  stats.glitched = stats.unresolved = iterate(reference_, series, {0.0, 0.0}, params.glitch_tolerance);
+  stats.render_seconds += std::chrono::duration<double>(Clock::now() - start).count();
+  estimate_saved(iterated, stats.render_seconds);
+
+  // Secondary references start from scratch
+  SeriesApproximation none;
+
+  ReferenceOrbit secondary;
+  Complex origin = {0.0, 0.0};
+  int center_x, center_y;
+  while (stats.unresolved > 0 && stats.passes <= params.max_references && FindGlitchCenter(glitched_, buffer.width, buffer.height, center_x, center_y)) {
+    // A reference inside the blob is never glitched against itself, so
+    // every pass settles at least that pixel
+    start = Clock::now();
+    double u, v;
+    PixelToCanvas(center_x, center_y, buffer.width, buffer.height, u, v);
+    origin = offset.At(u, v);
+    int limbs = params.lbrt.center.fraction_limbs();
+    secondary = ReferenceOrbit(params.lbrt.center + FixedComplex{FixedPoint(origin.re, limbs), FixedPoint(origin.im, limbs)});
+    secondary.Extend(max_iterations);
+    referenced = Clock::now();
+    stats.reference_seconds += std::chrono::duration<double>(referenced - start).count();
+
+    stats.passes++;
+    stats.unresolved = iterate(secondary, none, origin, params.glitch_tolerance);
+    stats.render_seconds += std::chrono::duration<double>(Clock::now() - referenced).count();
+  }
+
+  if (stats.unresolved > 0) {
+    // Out of references, settle for plain perturbation
+    start = Clock::now();
+    if (stats.passes > 1)
+      iterate(secondary, none, origin, 0.0);
+    else
+      iterate(reference_, series, origin, 0.0);
+    stats.render_seconds += std::chrono::duration<double>(Clock::now() - start).count();
+  }
+  return stats;
+}
+
+};  // namespace mandelbrot
@@ -0,0 +1,173 @@
+#ifndef MANDELBROT_CORE_PERTURBATION_H_
+#define MANDELBROT_CORE_PERTURBATION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mandelbrot-core/fixed_point.h"
+#include "mandelbrot-core/float_exp.h"
+#include "mandelbrot-core/renderer.h"
+#include "mandelbrot-core/scheduler.h"
+#include "mandelbrot-core/viewport.h"
+
+namespace mandelbrot {
+
+// Pixel spacing, relative to |c|, below which doubles (and mandelbrot.frag)
+// can no longer tell neighbouring pixels apart.
+inline constexpr double kDoubleSpacingLimit = 1e-13;
+
+// View radius below which the deltas of its pixels come close enough to the
+// 1e-308 floor of doubles to be iterated in FloatExp.
+inline constexpr double kFloatExpRadiusLimit = 1e-290;
+
+// Deltas from 2^kFloatExpDeltaExponent (about 1e-271) up are safe in double.
+inline constexpr int64_t kFloatExpDeltaExponent = -900;
+
+// A view too deep for doubles: a reference point at full precision and the
+// lbrt corners as offsets from it, scaled by 2^offset_exponent so they
+// survive views deeper than the 1e-308 of doubles.
+struct DeepViewport {
+  FixedComplex center;
+  Viewport offset;
+  int64_t offset_exponent = 0;
+
+  friend bool operator==(const DeepViewport &a, const DeepViewport &b) = default;
+};
+
+// Orbit Z_n of the reference point, iterated in fixed point at the precision
+// of the point and stored in double, which is all the pixels need of it.
+class ReferenceOrbit {
+ public:
+  ReferenceOrbit() = default;
+  explicit ReferenceOrbit(const FixedComplex &c);
+
+  // Iterates on from the last point until the orbit escapes or holds
+  // Z_0 ... Z_max_iterations.
+  void Extend(int max_iterations);
+
+  const FixedComplex &c() const { return c_; }
+
+  // Z_0 = 0, Z_1 = C, ...; if the orbit escaped, the last point lies past
+  // the bailout.
+  const std::vector<Complex> &points() const { return points_; }
+  bool escaped() const { return escaped_; }
+
+ private:
+  FixedComplex c_;
+  FixedComplex z_;
+  std::vector<Complex> points_ = {{0.0, 0.0}};
+  bool escaped_ = false;
+};
+
+// Iterates the pixel at offset dc from the reference as a delta from its
+// orbit, z_n = Z_n + d_n with d_{n+1} = 2 Z_n d_n + d_n^2 + dc, so only the
+// tiny d_n needs to be resolved. The pixel picks up the orbit at iteration
+// `skip` with d_skip = `delta`, from a SeriesApproximation, or at 0 with 0.
+//
+// With a positive `glitch_tolerance` the orbit is abandoned and `glitched`
+// set as soon as |z_n| < glitch_tolerance |Z_n| (Pauldelbrot's criterion:
+// the pixel no longer follows the dynamics of the reference, and d_n has
+// lost its precision) or the reference escapes first. With 0, such pixels
+// carry on regardless and finish in plain double after the reference.
+Escape PerturbedEscapeTime(const ReferenceOrbit &reference, Complex dc, int skip, Complex delta, int max_iterations, double glitch_tolerance, bool &glitched);
+
+template <typename C, typename R>
+class BasicBlaTable;
+using BlaTable = BasicBlaTable<Complex, double>;
+using ExpBlaTable = BasicBlaTable<ExpComplex, FloatExp>;
+
+// Work done by RebasedEscapeTime(), summed over pixels by the caller.
+struct RebaseCounters {
+  long rebases = 0;     // Restarts of the reference orbit
+  long long steps = 0;  // Steps taken, a BLA jump counting as one
+};
+
+// PerturbedEscapeTime() with rebasing: whenever |z_n| < |d_n|, or the pixel
+// reaches the end of the reference orbit, the pixel restarts the orbit with
+// d = z_n, which is exact since Z_0 = 0. The delta then never outgrows the
+// pixel, so one reference serves the whole frame without glitches.
+//
+// With a `bla` table of the reference, the pixel jumps ahead by the longest
+// step valid for its delta wherever there is one.
+Escape RebasedEscapeTime(const ReferenceOrbit &reference, const BlaTable *bla, Complex dc, int skip, Complex delta, int max_iterations, RebaseCounters &counters);
+
+// RebasedEscapeTime() for views past kFloatExpRadiusLimit: the delta is
+// iterated in FloatExp, jumping ahead with `exp_bla`, for as long as it is
+// out of range of a double, and in double with `bla` from there on.
+Escape RebasedEscapeTime(const ReferenceOrbit &reference, const ExpBlaTable *exp_bla, const BlaTable *bla, ExpComplex dc, int max_iterations, RebaseCounters &counters);
+
+struct PerturbationParams {
+  DeepViewport lbrt;
+  float max_it;
+
+  // Rebase pixels on the main reference instead of correcting glitches
+  bool rebase = true;
+  // Pauldelbrot glitch tolerance without rebasing, 0 disables glitch
+  // correction
+  double glitch_tolerance = 1e-3;
+  // Jump ahead with BLA tables of the main reference when rebasing
+  bool bla = true;
+  // Terms of the series approximation of the main reference, 0 disables it
+  int series_terms = 8;
+  // Secondary references a frame may add to correct glitches
+  int max_references = 32;
+  int tile_size = 64;
+  // Optional, one byte per pixel laid out like the buffer: only pixels
+  // where it is nonzero are rendered, the rest are left as they are
+  const unsigned char *mask = nullptr;
+};
+
+struct PerturbationStats {
+  int reference_length;      // Points in the main reference orbit
+  double reference_seconds;  // Spent computing reference orbits
+  double render_seconds;     // Spent iterating the pixels
+  int passes;                // Passes over the frame, one per reference
+  long glitched;             // Pixels the main reference glitched on
+  long unresolved;           // Pixels still glitched after the last pass
+  long rebases;              // Restarts of the reference orbit by pixels
+  int series_skip;           // Iterations the series skipped for every pixel
+  double series_seconds;     // Spent fitting the series, 0 if reused
+  double saved_seconds;      // Estimated pixel time the series saved, net
+  double bla_seconds;        // Spent building the BLA table, 0 if reused
+  size_t bla_bytes;          // Memory held by the BLA table
+  double bla_speedup;        // Iterations per step taken when rebasing
+  bool float_exp;            // Whether deltas were iterated in FloatExp
+};
+
+// Renders deep views by perturbation against a main reference orbit at the
+// reference point, kept across frames and only extended while the point and
+// its precision stay the same. A SeriesApproximation fitted to the view
+// lets its pixels skip the start of that orbit, and rebased pixels jump on
+// through a BlaTable of it, each as far as its own delta allows.
+//
+// Views past kFloatExpRadiusLimit are iterated in FloatExp, always rebased
+// and without series; shallower ones keep to doubles.
+//
+// Pixels are rebased by default, which needs no other reference. Without
+// rebasing, glitched pixels are corrected in further passes: each computes a new
+// reference at the center of the largest glitched blob and re-iterates only
+// the pixels still glitched. Whatever is left after max_references passes
+// is iterated once more without detection.
+//
+// The series and BLA tables are kept for the next call, which reuses them
+// while the view, max_it and the settings they depend on stay the same, so
+// a frame rendered in masked parts fits them once.
+class PerturbationRenderer {
+ public:
+  PerturbationStats Render(const PerturbationParams &params, IterationBuffer &buffer, TileScheduler &scheduler);
+
+ private:
+  struct Tables;
+
+  ReferenceOrbit reference_;
+  // Series and BLA tables of the last view
+  std::shared_ptr<Tables> tables_;
+  // Pixels whose last pass glitched, one per pixel of the frame
+  std::vector<unsigned char> glitched_;
+};
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_PERTURBATION_H_
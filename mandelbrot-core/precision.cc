@@ -0,0 +1,117 @@
+#include "mandelbrot-core/precision.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "mandelbrot-core/double_double.h"
+#include "mandelbrot-core/perturbation.h"
+
+namespace mandelbrot {
+
+namespace {
+
+// Spacing relative to |c| below which `precision` stops resolving pixels
+double SpacingLimit(Precision precision) {
+  switch (precision) {
+    case Precision::kFloat:
+      return kFloatSpacingLimit;
+    case Precision::kFloatFloat:
+      return kFloatFloatSpacingLimit;
+    case Precision::kDouble:
+      return kDoubleSpacingLimit;
+    case Precision::kDoubleDouble:
+      return kDoubleDoubleSpacingLimit;
+    default:
+      return 0.0;
+  }
+}
+
+double Mean(const std::deque<double> &values) {
+  return values.empty() ? 0.0 : std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+}
+
+};  // namespace
+
+const char *PrecisionName(Precision precision) {
+  switch (precision) {
+    case Precision::kFloat:
+      return "float";
+    case Precision::kFloatFloat:
+      return "float-float";
+    case Precision::kDouble:
+      return "double";
+    case Precision::kDoubleDouble:
+      return "double-double";
+    case Precision::kPerturbation:
+      return "perturbation";
+    case Precision::kPerturbationFloatExp:
+      return "perturbation (floatexp)";
+  }
+  return "";
+}
+
+bool Resolves(Precision precision, const FloatExp &spacing, double magnitude, const FloatExp &radius) {
+  // The renderer switches to FloatExp deltas by itself, at the same radius
+  if (precision == Precision::kPerturbation)
+    return radius >= FloatExp(kFloatExpRadiusLimit);
+  return spacing >= FloatExp(SpacingLimit(precision) * magnitude);
+}
+
+PrecisionPlanner::PrecisionPlanner(std::vector<Precision> ranking) : ranking_(std::move(ranking)) {
+  for (Precision precision : {Precision::kPerturbation, Precision::kPerturbationFloatExp}) {
+    if (std::find(ranking_.begin(), ranking_.end(), precision) == ranking_.end())
+      ranking_.push_back(precision);
+  }
+}
+
+Precision PrecisionPlanner::Plan(const FloatExp &spacing, double magnitude, const FloatExp &radius) {
+  // Kernels cheaper than one that still works need room to spare
+  bool current_resolves = current_ && Resolves(*current_, spacing, magnitude, radius);
+  FloatExp margin = current_resolves ? kHysteresis : 1.0;
+  Precision next = ranking_.back();
+  for (Precision precision : ranking_) {
+    if ((current_resolves && precision == *current_) || Resolves(precision, spacing / margin, magnitude, radius / margin)) {
+      next = precision;
+      break;
+    }
+  }
+
+  if (current_ && next != *current_) {
+    // A switch before the last one was measured in full keeps what it has
+    if (pending_ && pending_frames_ > 0)
+      transitions_.push_back(*pending_);
+    double before = recent_precision_ == *current_ ? Mean(recent_) : 0.0;
+    pending_ = Transition{*current_, next, spacing, before, 0.0};
+    pending_frames_ = 0;
+  }
+  current_ = next;
+  return next;
+}
+
+void PrecisionPlanner::Record(Precision precision, double frame_seconds) {
+  if (pending_ && precision == pending_->to) {
+    pending_->after_seconds = (pending_->after_seconds * pending_frames_ + frame_seconds) / (pending_frames_ + 1);
+    if (++pending_frames_ == kFramesPerMeasurement) {
+      transitions_.push_back(*pending_);
+      pending_.reset();
+    }
+  }
+
+  if (precision != recent_precision_) {
+    recent_precision_ = precision;
+    recent_.clear();
+  }
+  recent_.push_back(frame_seconds);
+  if (static_cast<int>(recent_.size()) > kFramesPerMeasurement)
+    recent_.pop_front();
+}
+
+std::optional<PrecisionPlanner::Transition> PrecisionPlanner::PopTransition() {
+  if (transitions_.empty())
+    return std::nullopt;
+  Transition transition = transitions_.front();
+  transitions_.pop_front();
+  return transition;
+}
+
+};  // namespace mandelbrot
@@ -0,0 +1,87 @@
+#ifndef MANDELBROT_CORE_PRECISION_H_
+#define MANDELBROT_CORE_PRECISION_H_
+
+#include <deque>
+#include <optional>
+#include <vector>
+
+#include "mandelbrot-core/float_exp.h"
+
+namespace mandelbrot {
+
+// Pixel spacing, relative to |c|, below which float (24 bits) can no longer
+// tell neighbouring pixels apart, with the margin of kDoubleSpacingLimit.
+inline constexpr double kFloatSpacingLimit = 1e-5;
+
+// The same for float-float, about 48 bits.
+inline constexpr double kFloatFloatSpacingLimit = 1e-12;
+
+// Kernels a frame can be rendered with, from the shallowest to the deepest
+// views they resolve.
+enum class Precision {
+  kFloat,                 // float.frag
+  kFloatFloat,            // float_float.frag
+  kDouble,                // mandelbrot.frag
+  kDoubleDouble,          // double_double.frag
+  kPerturbation,          // PerturbationRenderer, with double deltas
+  kPerturbationFloatExp,  // PerturbationRenderer, past kFloatExpRadiusLimit
+};
+
+const char *PrecisionName(Precision precision);
+
+// Whether `precision` resolves pixels `spacing` apart around |c| = `magnitude`
+// in a view of `radius` (the largest distance of a corner from c).
+bool Resolves(Precision precision, const FloatExp &spacing, double magnitude, const FloatExp &radius);
+
+// Picks, every frame, the cheapest kernel that still resolves the view, and
+// measures what each switch costs in frame time.
+class PrecisionPlanner {
+ public:
+  // Frames averaged on either side of a switch
+  static constexpr int kFramesPerMeasurement = 16;
+  // A cheaper kernel takes over only once it resolves pixels this many times
+  // closer than needed, so a view hovering at a limit does not flip-flop
+  static constexpr double kHysteresis = 2.0;
+
+  // A switch between kernels and the mean frame time on either side of it
+  struct Transition {
+    Precision from;
+    Precision to;
+    FloatExp spacing;
+    double before_seconds;
+    double after_seconds;
+  };
+
+  // `ranking` lists the kernels to use, cheapest first; the perturbation
+  // ones are appended if missing, so that every view has a kernel.
+  explicit PrecisionPlanner(std::vector<Precision> ranking);
+
+  const std::vector<Precision> &ranking() const { return ranking_; }
+
+  // The kernel for the next frame, see Resolves()
+  Precision Plan(const FloatExp &spacing, double magnitude, const FloatExp &radius);
+
+  // Time taken by a frame rendered with `precision`, whenever it is known
+  void Record(Precision precision, double frame_seconds);
+
+  // The oldest switch whose frame times are all in, if any, dropped from
+  // the planner
+  std::optional<Transition> PopTransition();
+
+ private:
+  std::vector<Precision> ranking_;
+  std::optional<Precision> current_;
+
+  // Latest frame times of one kernel
+  Precision recent_precision_ = Precision::kFloat;
+  std::deque<double> recent_;
+
+  // The last switch, until kFramesPerMeasurement frames after it are in
+  std::optional<Transition> pending_;
+  int pending_frames_ = 0;
+  std::deque<Transition> transitions_;
+};
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_PRECISION_H_
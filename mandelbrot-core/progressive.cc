@@ -0,0 +1,100 @@
+#include "mandelbrot-core/progressive.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "mandelbrot-core/escape_time.h"
+
+namespace mandelbrot {
+
+namespace {
+
+// Whether pixel (x, y) is first rendered on the grid `step` pixels apart
+bool OnGrid(int x, int y, int step) {
+  bool on = x % step == 0 && y % step == 0;
+  bool coarser = step < ProgressiveRenderer::kCoarsestStep && x % (2 * step) == 0 && y % (2 * step) == 0;
+  return on && !coarser;
+}
+
+};  // namespace
+
+ProgressiveStats ProgressiveRenderer::Render(const PerturbationParams &params, IterationBuffer &buffer, TileScheduler &scheduler, double budget_seconds) {
+  using Clock = std::chrono::steady_clock;
+  auto start = Clock::now();
+  int max_iterations = MaxIterations(params.max_it);
+  size_t pixels = static_cast<size_t>(buffer.width) * buffer.height;
+  ProgressiveStats stats{};
+
+  if (rendered_.empty() || buffer.width != width_ || buffer.height != height_ || params.lbrt != lbrt_ || max_iterations < max_iterations_) {
+    samples_.assign(pixels, 0.0f);
+    rendered_.assign(pixels, 0);
+  } else if (max_iterations > max_iterations_) {
+    // Only pixels that ran out of iterations can change
+    for (size_t i = 0; i < pixels; i++) {
+      if (std::isinf(samples_[i]))
+        rendered_[i] = 0;
+    }
+  }
+  lbrt_ = params.lbrt;
+  max_iterations_ = max_iterations;
+  width_ = buffer.width;
+  height_ = buffer.height;
+
+  PerturbationParams pass = params;
+  IterationBuffer samples{samples_.data(), width_, height_};
+  mask_.resize(pixels);
+  bool out_of_time = false;
+  for (int step = kCoarsestStep; step >= 1 && !out_of_time; step /= 2) {
+    // The coarsest grid in one go, so every block has a value
+    int band_rows = step == kCoarsestStep ? height_ : kBandRows * step * step;
+    for (int band = 0; band < height_; band += band_rows) {
+      std::fill(mask_.begin(), mask_.end(), 0);
+      long masked = 0;
+      for (int y = band; y < std::min(band + band_rows, height_); y++) {
+        for (int x = 0; x < width_; x++) {
+          size_t i = static_cast<size_t>(y) * width_ + x;
+          if (!rendered_[i] && OnGrid(x, y, step)) {
+            mask_[i] = rendered_[i] = 1;
+            masked++;
+          }
+        }
+      }
+      if (masked == 0)
+        continue;
+
+      pass.mask = mask_.data();
+      stats.last = renderer_.Render(pass, samples, scheduler);
+      stats.passes++;
+      if (std::chrono::duration<double>(Clock::now() - start).count() >= budget_seconds) {
+        out_of_time = true;
+        break;
+      }
+    }
+  }
+
+  // Every pixel takes its own sample or the corner of the finest block
+  // rendered around it
+  long rendered = 0;
+  stats.step = 1;
+  for (int y = 0; y < height_; y++) {
+    for (int x = 0; x < width_; x++) {
+      size_t i = static_cast<size_t>(y) * width_ + x;
+      rendered += rendered_[i];
+      for (int step = 1; step <= kCoarsestStep; step *= 2) {
+        size_t corner = static_cast<size_t>(y - y % step) * width_ + (x - x % step);
+        if (rendered_[corner]) {
+          buffer.At(x, y) = samples_[corner];
+          stats.step = std::max(stats.step, step);
+          break;
+        }
+      }
+    }
+  }
+  stats.coverage = static_cast<double>(rendered) / pixels;
+  stats.complete = rendered == static_cast<long>(pixels);
+  stats.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  return stats;
+}
+
+};  // namespace mandelbrot
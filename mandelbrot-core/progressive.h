@@ -0,0 +1,60 @@
+#ifndef MANDELBROT_CORE_PROGRESSIVE_H_
+#define MANDELBROT_CORE_PROGRESSIVE_H_
+
+#include <vector>
+
+#include "mandelbrot-core/perturbation.h"
+#include "mandelbrot-core/renderer.h"
+#include "mandelbrot-core/scheduler.h"
+
+namespace mandelbrot {
+
+struct ProgressiveStats {
+  int step;                // Finest grid rendered in full, in pixels
+  double coverage;         // Fraction of the pixels rendered
+  int passes;              // Calls to PerturbationRenderer::Render()
+  double seconds;          // Spent rendering this frame
+  bool complete;           // Whether every pixel is rendered
+  PerturbationStats last;  // Of the last pass
+};
+
+// Renders deep views coarse to fine within a time budget per frame: every
+// kCoarsestStep-th pixel of every kCoarsestStep-th row first (1/64 of
+// them), then the rest of every 4th (1/16), every 2nd (1/4) and finally
+// all of them, in bands of rows. Unrendered pixels take the value of the
+// lower left corner of their block on the finest grid rendered there. The
+// bands are masked passes of one PerturbationRenderer, which fits the series
+// and BLA tables of the view for the first of them only.
+//
+// Whatever the budget leaves over is picked up by the next frame of the
+// same view. Only the coarsest grid is always finished, so there is a
+// whole image to show. A rise in max_it only sends the interior pixels
+// back, since the escaped ones stay exact.
+class ProgressiveRenderer {
+ public:
+  // Pixels between samples of the first pass, along each side
+  static constexpr int kCoarsestStep = 8;
+  // Rows rendered at once in the last pass; passes over sparser grids take
+  // as many more rows as they skip, so every band costs about the same
+  static constexpr int kBandRows = 16;
+
+  ProgressiveStats Render(const PerturbationParams &params, IterationBuffer &buffer, TileScheduler &scheduler, double budget_seconds);
+
+  // Forgets the view, so the next frame starts over from the coarsest grid
+  void Reset() { rendered_.clear(); }
+
+ private:
+  PerturbationRenderer renderer_;
+  // Rendered pixels, laid out like the buffer; valid where rendered_ is set
+  std::vector<float> samples_;
+  std::vector<unsigned char> rendered_;
+  std::vector<unsigned char> mask_;
+  DeepViewport lbrt_;
+  int max_iterations_ = 0;
+  int width_ = 0;
+  int height_ = 0;
+};
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_PROGRESSIVE_H_
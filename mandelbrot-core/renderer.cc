@@ -0,0 +1,64 @@
+#include "mandelbrot-core/renderer.h"
+
+#include <cmath>
+#include <vector>
+
+#include "mandelbrot-core/escape_time.h"
+
+namespace mandelbrot {
+
+void RenderTile(const RenderParams &params, const Tile &tile, IterationBuffer &buffer) {
+  double spacing = std::abs(params.lbrt.top - params.lbrt.bottom) / buffer.height;
+  KernelConfig config{
+    ResolveKernel(params.kernel),
+    params.lane_mode,
+    MaxIterations(params.max_it),
+    params.cardioid_check,
+    params.periodicity_tolerance * spacing,
+  };
+
+  // Scratch space is reused by every tile a thread renders
+  thread_local std::vector<double> cr, ci;
+  thread_local std::vector<Escape> escapes;
+  int count = tile.width * tile.height;
+  cr.resize(count);
+  ci.resize(count);
+  escapes.resize(count);
+
+  for (int y = 0, i = 0; y < tile.height; y++) {
+    for (int x = 0; x < tile.width; x++, i++) {
+      double u, v;
+      PixelToCanvas(tile.x + x, tile.y + y, buffer.width, buffer.height, u, v);
+      Complex c = params.lbrt.At(u, v);
+      cr[i] = c.re;
+      ci[i] = c.im;
+    }
+  }
+
+  EscapeTimeBatch(config, cr.data(), ci.data(), count, escapes.data());
+
+  for (int y = 0, i = 0; y < tile.height; y++) {
+    for (int x = 0; x < tile.width; x++, i++)
+      buffer.At(tile.x + x, tile.y + y) = SmoothIteration(escapes[i], config.max_iterations);
+  }
+
+  if (buffer.periods) {
+    for (int y = 0, i = 0; y < tile.height; y++) {
+      for (int x = 0; x < tile.width; x++, i++)
+        buffer.periods[static_cast<long>(tile.y + y) * buffer.width + tile.x + x] = escapes[i].period;
+    }
+  }
+}
+
+void Render(const RenderParams &params, IterationBuffer &buffer) {
+  for (const Tile &tile : SplitIntoTiles(buffer.width, buffer.height, params.tile_size))
+    RenderTile(params, tile, buffer);
+}
+
+void Render(const RenderParams &params, IterationBuffer &buffer, TileScheduler &scheduler) {
+  scheduler.Run(SplitIntoTiles(buffer.width, buffer.height, params.tile_size), [&](const Tile &tile) {
+    RenderTile(params, tile, buffer);
+  });
+}
+
+};  // namespace mandelbrot
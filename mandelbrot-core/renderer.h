@@ -0,0 +1,54 @@
+#ifndef MANDELBROT_CORE_RENDERER_H_
+#define MANDELBROT_CORE_RENDERER_H_
+
+#include "mandelbrot-core/kernel.h"
+#include "mandelbrot-core/scheduler.h"
+#include "mandelbrot-core/tile.h"
+#include "mandelbrot-core/viewport.h"
+
+namespace mandelbrot {
+
+// Caller-owned buffer of smoothed iteration counts, one float per pixel,
+// stored row by row with row 0 at the bottom of the viewport (the layout
+// glTexImage2D expects). Pixels inside the set hold kInterior.
+struct IterationBuffer {
+  float *data;
+  int width;
+  int height;
+
+  // Optional, same layout: the period of the cycle interior pixels settled
+  // into, or 0 where none was detected
+  int *periods = nullptr;
+
+  float &At(int x, int y) { return data[static_cast<long>(y) * width + x]; }
+  const float &At(int x, int y) const { return data[static_cast<long>(y) * width + x]; }
+};
+
+// The uniforms mandelbrot.frag is drawn with, plus how to spend the CPU on
+// them.
+struct RenderParams {
+  Viewport lbrt;
+  float max_it;
+
+  Kernel kernel = Kernel::kAuto;
+  LaneMode lane_mode = LaneMode::kRefill;
+  bool cardioid_check = true;
+  // Brent cycle detection radius as a fraction of the pixel spacing, 0
+  // disables it
+  double periodicity_tolerance = 1e-3;
+  int tile_size = 64;
+};
+
+// Renders one tile of the buffer. The pixels of the tile form the queue of
+// a refill kernel.
+void RenderTile(const RenderParams &params, const Tile &tile, IterationBuffer &buffer);
+
+// Renders the whole buffer on the calling thread.
+void Render(const RenderParams &params, IterationBuffer &buffer);
+
+// Renders the whole buffer on every thread of `scheduler`.
+void Render(const RenderParams &params, IterationBuffer &buffer, TileScheduler &scheduler);
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_RENDERER_H_
@@ -0,0 +1,93 @@
+#include "mandelbrot-core/reprojection.h"
+
+#include <cmath>
+
+namespace mandelbrot {
+
+namespace {
+
+// Canvas coordinates of `point` in `viewport`, the inverse of Viewport::At()
+void PointToCanvas(const Viewport &viewport, Complex point, double &u, double &v) {
+  u = (point.re - viewport.left) / (viewport.right - viewport.left);
+  v = (point.im - viewport.bottom) / (viewport.top - viewport.bottom);
+}
+
+// Where pixel (x, y) of `from` lands among the pixels of `to`
+void MovePixel(const Viewport &from, const Viewport &to, double x, double y, int width, int height, double &to_x, double &to_y) {
+  // PixelToCanvas() only takes pixel centers
+  double ar = static_cast<double>(width) / static_cast<double>(height);
+  double u = 0.5 + ((x + 0.5) / width - 0.5) * ar, v = (y + 0.5) / height;
+  PointToCanvas(to, from.At(u, v), u, v);
+  CanvasToPixel(u, v, width, height, to_x, to_y);
+}
+
+};  // namespace
+
+ReprojectionStats Reprojector::Reproject(const Viewport &from, const Viewport &to, int max_iterations, IterationBuffer &buffer) {
+  long pixels = static_cast<long>(buffer.width) * buffer.height;
+  ReprojectionStats stats{};
+
+  // Counts that escaped late may not escape at all by a lower limit
+  if (buffer.width != width_ || buffer.height != height_ || max_iterations < max_iterations_)
+    Reset();
+  bool reset = offsets_.empty();
+  width_ = buffer.width;
+  height_ = buffer.height;
+
+  mask_.assign(pixels, 1);
+  if (reset) {
+    offsets_.assign(pixels, {0.0, 0.0});
+    max_iterations_ = max_iterations;
+    stats.rendered = pixels;
+    return stats;
+  }
+
+  previous_.assign(buffer.data, buffer.data + pixels);
+  std::vector<Complex> offsets(pixels, {0.0, 0.0});
+  for (int y = 0; y < height_; y++) {
+    for (int x = 0; x < width_; x++) {
+      long i = static_cast<long>(y) * width_ + x;
+      double from_x, from_y;
+      MovePixel(to, from, x, y, width_, height_, from_x, from_y);
+      long nearest_x = std::lround(from_x), nearest_y = std::lround(from_y);
+      if (nearest_x < 0 || nearest_y < 0 || nearest_x >= width_ || nearest_y >= height_) {
+        stats.rendered++;
+        continue;
+      }
+
+      // The value was computed off the center of its own pixel already
+      long j = nearest_y * width_ + nearest_x;
+      double sample_x, sample_y;
+      MovePixel(from, to, nearest_x + offsets_[j].re, nearest_y + offsets_[j].im, width_, height_, sample_x, sample_y);
+      Complex offset = {sample_x - x, sample_y - y};
+      float value = previous_[j];
+      bool close = std::hypot(offset.re, offset.im) <= kMaxOffset;
+      if (!close || (std::isinf(value) && max_iterations != max_iterations_)) {
+        stats.rendered++;
+        continue;
+      }
+
+      buffer.data[i] = value;
+      offsets[i] = offset;
+      // Rounding leaves pans by whole pixels a little off center
+      bool centered = std::hypot(offset.re, offset.im) < 1e-6;
+      if (centered)
+        offsets[i] = {0.0, 0.0};
+      if (!centered && ((x & 1) + 2 * (y & 1) + frame_) % kRefinePeriod == 0) {
+        stats.refined++;
+        offsets[i] = {0.0, 0.0};
+        continue;
+      }
+      mask_[i] = 0;
+      stats.reused++;
+    }
+  }
+
+  offsets_ = std::move(offsets);
+  max_iterations_ = max_iterations;
+  frame_++;
+  stats.reuse_rate = static_cast<double>(stats.reused) / pixels;
+  return stats;
+}
+
+};  // namespace mandelbrot
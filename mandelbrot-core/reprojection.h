@@ -0,0 +1,61 @@
+#ifndef MANDELBROT_CORE_REPROJECTION_H_
+#define MANDELBROT_CORE_REPROJECTION_H_
+
+#include <vector>
+
+#include "mandelbrot-core/renderer.h"
+#include "mandelbrot-core/viewport.h"
+
+namespace mandelbrot {
+
+// Work saved by one Reprojector::Reproject().
+struct ReprojectionStats {
+  long reused;        // Pixels carried over from the last frame
+  long rendered;      // Pixels without a close enough sample
+  long refined;       // Carried-over pixels queued to be made exact
+  double reuse_rate;  // reused / pixels
+};
+
+// Carries the iteration counts of one frame of a zoom over to the next,
+// which differs from it by a small scale, so that only the pixels without
+// a close enough sample in the last frame need rendering.
+//
+// Every pixel remembers how far from its center its value was computed. A
+// pixel takes the value of the nearest pixel of the last frame as long as
+// that stays within kMaxOffset; the rest, and pixels that did not escape
+// by a lower iteration limit, are left to the renderer. A quarter of the
+// carried-over pixels, interleaved 2x2, is rendered again every frame, so
+// none stays off center for more than kRefinePeriod frames.
+class Reprojector {
+ public:
+  // Furthest a reused value may sit from the center of its pixel, in pixels
+  static constexpr double kMaxOffset = 0.5;
+  // Frames over which every carried-over pixel is rendered again once
+  static constexpr int kRefinePeriod = 4;
+
+  // Moves `buffer`, last filled for `from`, to the view `to`, rendered at
+  // `max_iterations`. Pixels to render are then nonzero in mask(). The
+  // views must be offsets from the same point at the same scale. With a
+  // different buffer size than last time every pixel is rendered.
+  ReprojectionStats Reproject(const Viewport &from, const Viewport &to, int max_iterations, IterationBuffer &buffer);
+
+  // Forgets the last frame, so the next one renders every pixel
+  void Reset() { offsets_.clear(); }
+
+  // One byte per pixel, laid out like IterationBuffer
+  const std::vector<unsigned char> &mask() const { return mask_; }
+
+ private:
+  std::vector<float> previous_;
+  // Offset of each value from the center of its pixel, in pixels
+  std::vector<Complex> offsets_;
+  std::vector<unsigned char> mask_;
+  int width_ = 0;
+  int height_ = 0;
+  int max_iterations_ = 0;
+  long frame_ = 0;
+};
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_REPROJECTION_H_
@@ -0,0 +1,47 @@
+#include "mandelbrot-core/resolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mandelbrot {
+
+ResolutionController::ResolutionController(double target_seconds, double min_scale)
+    : target_seconds_(target_seconds), min_scale_(std::clamp(min_scale, kStep, 1.0)) {}
+
+bool ResolutionController::Record(double frame_seconds) {
+  // Still the frame before the change
+  if (frames_ < 0) {
+    frames_++;
+    return false;
+  }
+  mean_seconds_ = frames_ == 0 ? frame_seconds : mean_seconds_ + (frame_seconds - mean_seconds_) * kSmoothing;
+  if (++frames_ < kSettleFrames || mean_seconds_ <= 0.0)
+    return false;
+  if (std::fabs(mean_seconds_ - target_seconds_) <= target_seconds_ * kTolerance)
+    return false;
+
+  // The largest step predicted to keep within the target
+  double ideal = scale_ * std::sqrt(target_seconds_ / mean_seconds_);
+  double next = std::clamp(std::floor(ideal / kStep) * kStep, min_scale_, 1.0);
+  // A faster frame only ever moves the scale up
+  if (mean_seconds_ < target_seconds_)
+    next = std::max(next, scale_);
+  if (next == scale_)
+    return false;
+
+  scale_ = next;
+  frames_ = -kLateFrames;
+  return true;
+}
+
+void ResolutionController::Reset() {
+  scale_ = 1.0;
+  mean_seconds_ = 0.0;
+  frames_ = 0;
+}
+
+int ResolutionController::Scaled(int size) const {
+  return std::max(1, static_cast<int>(std::lround(size * scale_)));
+}
+
+};  // namespace mandelbrot
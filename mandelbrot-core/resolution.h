@@ -0,0 +1,53 @@
+#ifndef MANDELBROT_CORE_RESOLUTION_H_
+#define MANDELBROT_CORE_RESOLUTION_H_
+
+namespace mandelbrot {
+
+// Scales the resolution frames are rendered at, along each side, so that
+// they take about a target time: frame time goes with the pixel count, so
+// a frame that takes t renders in the target time at sqrt(target / t) times
+// the scale.
+//
+// Scales snap to multiples of kStep, the largest one predicted to keep within
+// the target, and only change once the mean frame time leaves the target by
+// kTolerance, so the resolution does not flicker between neighbouring steps.
+class ResolutionController {
+ public:
+  static constexpr double kStep = 1.0 / 16.0;
+  static constexpr double kTolerance = 0.15;
+  // Weight of the newest frame in the mean frame time
+  static constexpr double kSmoothing = 0.25;
+  // Frame times read back after a change that still belong to frames before
+  // it, as GPU timers read a frame late, and which are dropped
+  static constexpr int kLateFrames = 1;
+  // Frames measured at a scale before it changes again
+  static constexpr int kSettleFrames = 3;
+
+  // No finer than full resolution nor coarser than `min_scale` of it
+  ResolutionController(double target_seconds, double min_scale);
+
+  // Time taken by a frame rendered at scale(); whether the scale changed
+  bool Record(double frame_seconds);
+
+  // Back to full resolution, forgetting the frame times
+  void Reset();
+
+  double scale() const { return scale_; }
+  double target_seconds() const { return target_seconds_; }
+  // Mean frame time, 0 until measured
+  double mean_seconds() const { return mean_seconds_; }
+
+  // `size` pixels at the current scale
+  int Scaled(int size) const;
+
+ private:
+  double target_seconds_;
+  double min_scale_;
+  double scale_ = 1.0;
+  double mean_seconds_ = 0.0;
+  int frames_ = 0;
+};
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_RESOLUTION_H_
@@ -0,0 +1,107 @@
+#include "mandelbrot-core/scheduler.h"
+
+#include <algorithm>
+
+namespace mandelbrot {
+
+TileScheduler::TileScheduler(int threads) {
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (int i = 0; i < threads; i++)
+    workers_.push_back(std::make_unique<Worker>());
+
+  // Worker 0 is whoever calls Run()
+  for (int i = 1; i < threads; i++)
+    threads_.emplace_back(&TileScheduler::WorkerLoop, this, i);
+}
+
+TileScheduler::~TileScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread &thread : threads_)
+    thread.join();
+}
+
+void TileScheduler::Run(const std::vector<Tile> &tiles, const std::function<void(const Tile &)> &work) {
+  // Seed each deque with a contiguous run of tiles, neighbours share cache
+  size_t count = workers_.size();
+  for (size_t i = 0; i < count; i++) {
+    std::lock_guard<std::mutex> lock(workers_[i]->mutex);
+    workers_[i]->tiles.assign(tiles.begin() + tiles.size() * i / count, tiles.begin() + tiles.size() * (i + 1) / count);
+  }
+  steals_ = 0;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    work_ = &work;
+    running_ = static_cast<int>(threads_.size());
+    generation_++;
+  }
+  wake_.notify_all();
+
+  Drain(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  finished_.wait(lock, [this] { return running_ == 0; });
+  work_ = nullptr;
+}
+
+void TileScheduler::WorkerLoop(int index) {
+  long generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [&] { return stop_ || generation_ != generation; });
+      if (stop_)
+        return;
+      generation = generation_;
+    }
+
+    Drain(index);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_--;
+    }
+    finished_.notify_one();
+  }
+}
+
+void TileScheduler::Drain(int index) {
+  // No tiles are added during a run, so once every deque is empty we are done
+  Tile tile;
+  while (Pop(index, tile) || Steal(index, tile))
+    (*work_)(tile);
+}
+
+bool TileScheduler::Pop(int index, Tile &tile) {
+  Worker &worker = *workers_[index];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  if (worker.tiles.empty())
+    return false;
+  tile = worker.tiles.back();
+  worker.tiles.pop_back();
+  return true;
+}
+
+bool TileScheduler::Steal(int thief, Tile &tile) {
+  // Start with the next worker so thieves spread over different victims
+  int count = threads();
+  for (int i = 1; i < count; i++) {
+    Worker &victim = *workers_[(thief + i) % count];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tiles.empty()) {
+      tile = victim.tiles.front();
+      victim.tiles.pop_front();
+      steals_++;
+      return true;
+    }
+  }
+  return false;
+}
+
+};  // namespace mandelbrot
@@ -0,0 +1,67 @@
+#ifndef MANDELBROT_CORE_SCHEDULER_H_
+#define MANDELBROT_CORE_SCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mandelbrot-core/tile.h"
+
+namespace mandelbrot {
+
+// Spreads the tiles of an image across a pool of threads. Every thread owns
+// a deque seeded with a contiguous run of tiles and works through it from
+// the back; once it runs dry it steals from the front of the others, so a
+// thread that drew cheap exterior tiles ends up helping with the interior.
+class TileScheduler {
+ public:
+  // `threads` counts the thread that calls Run(); 0 uses one per hardware
+  // thread.
+  explicit TileScheduler(int threads = 0);
+  ~TileScheduler();
+
+  TileScheduler(const TileScheduler &) = delete;
+  TileScheduler &operator=(const TileScheduler &) = delete;
+
+  int threads() const { return static_cast<int>(workers_.size()); }
+
+  // Tiles taken from another thread's deque during the last Run().
+  long steals() const { return steals_; }
+
+  // Calls `work` once for every tile, from any of the threads, and returns
+  // when all of them are done.
+  void Run(const std::vector<Tile> &tiles, const std::function<void(const Tile &)> &work);
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Tile> tiles;
+  };
+
+  void WorkerLoop(int index);
+  void Drain(int index);
+  bool Pop(int index, Tile &tile);
+  bool Steal(int thief, Tile &tile);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable finished_;
+  const std::function<void(const Tile &)> *work_ = nullptr;
+  long generation_ = 0;
+  int running_ = 0;
+  bool stop_ = false;
+
+  std::atomic<long> steals_ = 0;
+};
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_SCHEDULER_H_
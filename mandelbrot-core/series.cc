@@ -0,0 +1,98 @@
+#include "mandelbrot-core/series.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mandelbrot {
+
+namespace {
+
+// The last term may contribute this much of the first
+constexpr double kTruncationTolerance = 1e-12;
+// Relative disagreement allowed between the series and a corner
+constexpr double kCornerTolerance = 1e-9;
+
+Complex Multiply(Complex a, Complex b) { return {a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re}; }
+
+double Norm(Complex a) { return a.re * a.re + a.im * a.im; }
+
+// Horner evaluation of the scaled series at dc / radius
+Complex Evaluate(const std::vector<Complex> &coefficients, Complex t) {
+  Complex sum = {0.0, 0.0};
+  for (int k = static_cast<int>(coefficients.size()) - 1; k >= 0; k--) {
+    sum = Multiply(sum, t);
+    sum.re += coefficients[k].re;
+    sum.im += coefficients[k].im;
+  }
+  return Multiply(sum, t);
+}
+
+};  // namespace
+
+SeriesApproximation::SeriesApproximation(const ReferenceOrbit &reference, const Viewport &offset, int terms, int max_iterations) {
+  const std::vector<Complex> &orbit = reference.points();
+  int last = static_cast<int>(orbit.size()) - 1;
+
+  Complex corners[4] = {
+      {offset.left, offset.bottom},
+      {offset.right, offset.bottom},
+      {offset.left, offset.top},
+      {offset.right, offset.top},
+  };
+  for (const Complex &corner : corners)
+    radius_ = std::max(radius_, std::sqrt(Norm(corner)));
+  if (terms < 1 || radius_ == 0.0)
+    return;
+
+  // Deltas of the corners by plain perturbation, the truth the series must
+  // match
+  Complex deltas[4] = {};
+
+  coefficients_.assign(terms, {0.0, 0.0});
+  std::vector<Complex> next(terms);
+  while (skip_ + 1 < std::min(last, max_iterations)) {
+    const Complex &z = orbit[skip_];
+    Complex two_z = {2 * z.re, 2 * z.im};
+    for (int k = 0; k < terms; k++) {
+      // a_{k+1} = 2 Z a_{k+1} + sum of a_{i+1} a_{j+1} over i + j = k - 1
+      Complex a = Multiply(two_z, coefficients_[k]);
+      for (int i = 0; i < k; i++) {
+        Complex product = Multiply(coefficients_[i], coefficients_[k - 1 - i]);
+        a.re += product.re;
+        a.im += product.im;
+      }
+      next[k] = a;
+    }
+    next[0].re += radius_;
+
+    double first = Norm(next[0]);
+    bool valid = std::isfinite(first) && Norm(next[terms - 1]) <= kTruncationTolerance * kTruncationTolerance * first;
+
+    const Complex &next_z = orbit[skip_ + 1];
+    for (int i = 0; i < 4 && valid; i++) {
+      Complex &d = deltas[i];
+      Complex dc = corners[i];
+      d = {2 * (z.re * d.re - z.im * d.im) + (d.re * d.re - d.im * d.im) + dc.re,
+           2 * (z.re * d.im + z.im * d.re) + 2 * d.re * d.im + dc.im};
+
+      // A corner that would need rebasing has left the reference behind
+      Complex full = {next_z.re + d.re, next_z.im + d.im};
+      Complex series = Evaluate(next, {dc.re / radius_, dc.im / radius_});
+      Complex error = {series.re - d.re, series.im - d.im};
+      valid = Norm(full) >= Norm(d) && Norm(error) <= kCornerTolerance * kCornerTolerance * Norm(d);
+    }
+    if (!valid)
+      break;
+
+    coefficients_.swap(next);
+    skip_++;
+  }
+}
+
+Complex SeriesApproximation::Delta(Complex dc) const {
+  if (skip_ == 0)
+    return {0.0, 0.0};
+  return Evaluate(coefficients_, {dc.re / radius_, dc.im / radius_});
+}
+
+};  // namespace mandelbrot
@@ -0,0 +1,42 @@
+#ifndef MANDELBROT_CORE_SERIES_H_
+#define MANDELBROT_CORE_SERIES_H_
+
+#include <vector>
+
+#include "mandelbrot-core/perturbation.h"
+#include "mandelbrot-core/viewport.h"
+
+namespace mandelbrot {
+
+// Truncated power series d_n = a_1 dc + a_2 dc^2 + ... + a_K dc^K of the
+// delta of every pixel from a reference orbit, fitted alongside the orbit
+// with a_{n+1} = 2 Z_n a_n + (the dc^k terms of d_n^2) + dc. While it holds,
+// evaluating it replaces the first n iterations of every pixel.
+class SeriesApproximation {
+ public:
+  SeriesApproximation() = default;
+
+  // Fits `terms` coefficients along `reference` for as long as the series
+  // stays exact to double precision over `offset`: the last term must stay
+  // negligible at the radius of the view, and the series must agree with
+  // plain perturbation at its lbrt corners. Stops short of the end of the
+  // orbit and of max_iterations.
+  SeriesApproximation(const ReferenceOrbit &reference, const Viewport &offset, int terms, int max_iterations);
+
+  // Iterations every pixel of the view can skip
+  int skip() const { return skip_; }
+
+  // d_skip of the pixel at offset dc from the reference
+  Complex Delta(Complex dc) const;
+
+ private:
+  int skip_ = 0;
+  double radius_ = 0.0;
+  // a_k radius^k at skip_, lowest order first; scaled so that deep views
+  // cannot overflow the higher orders
+  std::vector<Complex> coefficients_;
+};
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_SERIES_H_
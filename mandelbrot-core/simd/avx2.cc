@@ -0,0 +1,274 @@
+#include "mandelbrot-core/simd/simd.h"
+
+#if MANDELBROT_X86_SIMD
+
+#include <immintrin.h>
+
+#include <algorithm>
+
+namespace mandelbrot {
+namespace simd {
+
+namespace {
+
+constexpr int kLanes = 4;
+
+// Iterates one vector of points. Lanes leave the active mask as soon as they
+// fail the bailout test; their norm is latched at that moment, so it does
+// not matter that they keep iterating (and overflow) with the others. Every
+// active lane has run the same number of iterations, so they share Brent's
+// save schedule.
+template <bool kPeriodicity>
+__attribute__((target("avx2")))
+void Iterate(const double *cr, const double *ci, const KernelConfig &config, __m256i lanes, Escape *escapes) {
+  const __m256d bailout = _mm256_set1_pd(kBailout);
+  const __m256d two = _mm256_set1_pd(2.0);
+  const __m256d tolerance2 = _mm256_set1_pd(config.periodicity_tolerance * config.periodicity_tolerance);
+  const __m256d c_re = _mm256_loadu_pd(cr);
+  const __m256d c_im = _mm256_loadu_pd(ci);
+
+  __m256d zx = _mm256_setzero_pd(), zy = _mm256_setzero_pd();
+  __m256d zx2 = _mm256_setzero_pd(), zy2 = _mm256_setzero_pd();
+  __m256d norm = _mm256_setzero_pd();
+  __m256i it = _mm256_setzero_si256();
+  __m256d active = _mm256_castsi256_pd(lanes);
+
+  __m256d sx = _mm256_setzero_pd(), sy = _mm256_setzero_pd();
+  __m256d periodic = _mm256_setzero_pd();
+  __m256i period = _mm256_setzero_si256();
+  int saved = 0;
+  long long save_at = 1;
+
+  for (int i = 0; i < config.max_iterations; i++) {
+    __m256d inside = _mm256_and_pd(active, _mm256_cmp_pd(_mm256_add_pd(zx2, zy2), bailout, _CMP_LE_OQ));
+    // Latch the norm of the lanes escaping now
+    norm = _mm256_blendv_pd(norm, _mm256_add_pd(zx2, zy2), _mm256_andnot_pd(inside, active));
+    active = inside;
+    if (_mm256_movemask_pd(active) == 0)
+      break;
+
+    zy = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(two, zx), zy), c_im);
+    zx = _mm256_add_pd(_mm256_sub_pd(zx2, zy2), c_re);
+    zx2 = _mm256_mul_pd(zx, zx);
+    zy2 = _mm256_mul_pd(zy, zy);
+    // Active lanes are all ones, i.e. -1
+    it = _mm256_sub_epi64(it, _mm256_castpd_si256(active));
+
+    if constexpr (kPeriodicity) {
+      __m256d dx = _mm256_sub_pd(zx, sx), dy = _mm256_sub_pd(zy, sy);
+      __m256d distance2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+      __m256d cycle = _mm256_and_pd(active, _mm256_cmp_pd(distance2, tolerance2, _CMP_LE_OQ));
+      if (_mm256_movemask_pd(cycle) != 0) {
+        period = _mm256_castpd_si256(_mm256_blendv_pd(_mm256_castsi256_pd(period), _mm256_castsi256_pd(_mm256_set1_epi64x(i + 1 - saved)), cycle));
+        periodic = _mm256_or_pd(periodic, cycle);
+        active = _mm256_andnot_pd(cycle, active);
+      }
+      if (i + 1 == save_at) {
+        sx = zx;
+        sy = zy;
+        saved = i + 1;
+        save_at *= 2;
+      }
+    }
+  }
+  // Lanes that ran out of budget
+  norm = _mm256_blendv_pd(norm, _mm256_add_pd(zx2, zy2), active);
+
+  alignas(32) double norms[kLanes];
+  alignas(32) long long its[kLanes], periods[kLanes], cycles[kLanes];
+  _mm256_store_pd(norms, norm);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(its), it);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(periods), period);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(cycles), _mm256_castpd_si256(periodic));
+  for (int l = 0; l < kLanes; l++) {
+    if (cycles[l])
+      escapes[l] = {config.max_iterations, 0.0, static_cast<int>(periods[l])};
+    else
+      escapes[l] = {static_cast<int>(its[l]), norms[l]};
+  }
+}
+
+template <bool kPeriodicity>
+__attribute__((target("avx2")))
+void Masked(const KernelConfig &config, const double *cr, const double *ci, int count, Escape *escapes) {
+  int i = 0;
+  for (; i + kLanes <= count; i += kLanes)
+    Iterate<kPeriodicity>(cr + i, ci + i, config, _mm256_set1_epi64x(-1), escapes + i);
+
+  if (i < count) {
+    // Pad the tail with disabled lanes
+    int tail = count - i;
+    double tail_cr[kLanes] = {}, tail_ci[kLanes] = {};
+    Escape tail_escapes[kLanes];
+    std::copy(cr + i, cr + count, tail_cr);
+    std::copy(ci + i, ci + count, tail_ci);
+    __m256i lanes = _mm256_cmpgt_epi64(_mm256_set1_epi64x(tail), _mm256_setr_epi64x(0, 1, 2, 3));
+    Iterate<kPeriodicity>(tail_cr, tail_ci, config, lanes, tail_escapes);
+    std::copy(tail_escapes, tail_escapes + tail, escapes + i);
+  }
+  // GCC does not always clear the upper halves here, which makes the SSE
+  // code of the caller pay for false dependencies
+  _mm256_zeroupper();
+}
+
+// Each lane follows its own Brent schedule, since lanes start their pixels
+// at different times.
+template <bool kPeriodicity>
+__attribute__((target("avx2")))
+void Refill(const KernelConfig &config, const double *cr, const double *ci, int count, Escape *escapes) {
+  const __m256d bailout = _mm256_set1_pd(kBailout);
+  const __m256d two = _mm256_set1_pd(2.0);
+  const __m256d tolerance2 = _mm256_set1_pd(config.periodicity_tolerance * config.periodicity_tolerance);
+  const __m256i one = _mm256_set1_epi64x(1);
+  const __m256i last = _mm256_set1_epi64x(config.max_iterations - 1);
+
+  // Lanes are reloaded through memory, which only happens when one of them
+  // is done. Lanes left without a pixel iterate c = 0 and are ignored.
+  alignas(32) double lane_cr[kLanes] = {}, lane_ci[kLanes] = {};
+  alignas(32) double lane_zx[kLanes] = {}, lane_zy[kLanes] = {};
+  alignas(32) double lane_zx2[kLanes] = {}, lane_zy2[kLanes] = {};
+  alignas(32) double lane_sx[kLanes] = {}, lane_sy[kLanes] = {};
+  alignas(32) double lane_norm[kLanes];
+  alignas(32) long long lane_it[kLanes] = {};
+  alignas(32) long long lane_saved[kLanes] = {}, lane_save_at[kLanes] = {1, 1, 1, 1};
+  alignas(32) long long lane_cycle[kLanes] = {}, lane_period[kLanes] = {};
+  alignas(32) long long lane_live[kLanes] = {};
+  int lane_pixel[kLanes];
+
+  int next = 0;
+  for (int l = 0; l < kLanes && next < count; l++, next++) {
+    lane_pixel[l] = next;
+    lane_cr[l] = cr[next];
+    lane_ci[l] = ci[next];
+    lane_live[l] = -1;
+  }
+  if (next == 0)
+    return;
+
+  __m256d c_re = _mm256_load_pd(lane_cr), c_im = _mm256_load_pd(lane_ci);
+  __m256d zx = _mm256_setzero_pd(), zy = _mm256_setzero_pd();
+  __m256d zx2 = _mm256_setzero_pd(), zy2 = _mm256_setzero_pd();
+  __m256i it = _mm256_setzero_si256();
+  __m256d live = _mm256_load_pd(reinterpret_cast<const double *>(lane_live));
+
+  __m256d sx = _mm256_setzero_pd(), sy = _mm256_setzero_pd();
+  __m256i saved = _mm256_setzero_si256(), save_at = one;
+  __m256d cycle = _mm256_setzero_pd();
+  __m256i period = _mm256_setzero_si256();
+
+  while (true) {
+    // A pixel is done when it fails the bailout test, its budget is spent or
+    // its orbit closed a cycle on the last iteration
+    __m256d norm = _mm256_add_pd(zx2, zy2);
+    __m256d done = _mm256_or_pd(_mm256_cmp_pd(norm, bailout, _CMP_NLE_UQ), _mm256_castsi256_pd(_mm256_cmpgt_epi64(it, last)));
+    if constexpr (kPeriodicity)
+      done = _mm256_or_pd(done, cycle);
+    int done_lanes = _mm256_movemask_pd(_mm256_and_pd(done, live));
+
+    if (done_lanes != 0) {
+      _mm256_store_pd(lane_cr, c_re);
+      _mm256_store_pd(lane_ci, c_im);
+      _mm256_store_pd(lane_zx, zx);
+      _mm256_store_pd(lane_zy, zy);
+      _mm256_store_pd(lane_zx2, zx2);
+      _mm256_store_pd(lane_zy2, zy2);
+      _mm256_store_pd(lane_norm, norm);
+      _mm256_store_si256(reinterpret_cast<__m256i *>(lane_it), it);
+      if constexpr (kPeriodicity) {
+        _mm256_store_pd(lane_sx, sx);
+        _mm256_store_pd(lane_sy, sy);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lane_saved), saved);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lane_save_at), save_at);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lane_cycle), _mm256_castpd_si256(cycle));
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lane_period), period);
+      }
+
+      int live_lanes = 0;
+      for (int l = 0; l < kLanes; l++) {
+        if (done_lanes & (1 << l)) {
+          if (kPeriodicity && lane_cycle[l])
+            escapes[lane_pixel[l]] = {config.max_iterations, 0.0, static_cast<int>(lane_period[l])};
+          else
+            escapes[lane_pixel[l]] = {static_cast<int>(lane_it[l]), lane_norm[l]};
+
+          lane_zx[l] = lane_zy[l] = lane_zx2[l] = lane_zy2[l] = 0.0;
+          lane_sx[l] = lane_sy[l] = 0.0;
+          lane_it[l] = lane_saved[l] = lane_cycle[l] = 0;
+          lane_save_at[l] = 1;
+          if (next < count) {
+            lane_pixel[l] = next;
+            lane_cr[l] = cr[next];
+            lane_ci[l] = ci[next];
+            next++;
+          } else {
+            lane_cr[l] = lane_ci[l] = 0.0;
+            lane_live[l] = 0;
+          }
+        }
+        live_lanes |= lane_live[l] != 0;
+      }
+      if (!live_lanes)
+        break;
+
+      c_re = _mm256_load_pd(lane_cr);
+      c_im = _mm256_load_pd(lane_ci);
+      zx = _mm256_load_pd(lane_zx);
+      zy = _mm256_load_pd(lane_zy);
+      zx2 = _mm256_load_pd(lane_zx2);
+      zy2 = _mm256_load_pd(lane_zy2);
+      it = _mm256_load_si256(reinterpret_cast<const __m256i *>(lane_it));
+      live = _mm256_load_pd(reinterpret_cast<const double *>(lane_live));
+      if constexpr (kPeriodicity) {
+        sx = _mm256_load_pd(lane_sx);
+        sy = _mm256_load_pd(lane_sy);
+        saved = _mm256_load_si256(reinterpret_cast<const __m256i *>(lane_saved));
+        save_at = _mm256_load_si256(reinterpret_cast<const __m256i *>(lane_save_at));
+        cycle = _mm256_load_pd(reinterpret_cast<const double *>(lane_cycle));
+      }
+      // Refilled pixels face the done test before their first iteration, as
+      // in the scalar loop, so a budget of 0 runs none
+      continue;
+    }
+
+    zy = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(two, zx), zy), c_im);
+    zx = _mm256_add_pd(_mm256_sub_pd(zx2, zy2), c_re);
+    zx2 = _mm256_mul_pd(zx, zx);
+    zy2 = _mm256_mul_pd(zy, zy);
+    it = _mm256_add_epi64(it, one);
+
+    if constexpr (kPeriodicity) {
+      __m256d dx = _mm256_sub_pd(zx, sx), dy = _mm256_sub_pd(zy, sy);
+      __m256d distance2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+      cycle = _mm256_cmp_pd(distance2, tolerance2, _CMP_LE_OQ);
+      period = _mm256_sub_epi64(it, saved);
+
+      __m256i save = _mm256_cmpeq_epi64(it, save_at);
+      sx = _mm256_blendv_pd(sx, zx, _mm256_castsi256_pd(save));
+      sy = _mm256_blendv_pd(sy, zy, _mm256_castsi256_pd(save));
+      saved = _mm256_blendv_epi8(saved, it, save);
+      save_at = _mm256_blendv_epi8(save_at, _mm256_add_epi64(save_at, save_at), save);
+    }
+  }
+  _mm256_zeroupper();
+}
+
+};  // namespace
+
+void EscapeTimeAvx2(const KernelConfig &config, const double *cr, const double *ci, int count, Escape *escapes) {
+  if (config.periodicity_tolerance > 0)
+    Masked<true>(config, cr, ci, count, escapes);
+  else
+    Masked<false>(config, cr, ci, count, escapes);
+}
+
+void EscapeTimeRefillAvx2(const KernelConfig &config, const double *cr, const double *ci, int count, Escape *escapes) {
+  if (config.periodicity_tolerance > 0)
+    Refill<true>(config, cr, ci, count, escapes);
+  else
+    Refill<false>(config, cr, ci, count, escapes);
+}
+
+};  // namespace simd
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_X86_SIMD
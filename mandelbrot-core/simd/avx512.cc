@@ -0,0 +1,223 @@
+#include "mandelbrot-core/simd/simd.h"
+
+#if MANDELBROT_X86_SIMD
+
+#include <immintrin.h>
+
+#include <algorithm>
+
+namespace mandelbrot {
+namespace simd {
+
+namespace {
+
+constexpr int kLanes = 8;
+
+// Same scheme as the AVX2 kernel, with the active lanes kept in a mask
+// register instead of a vector.
+template <bool kPeriodicity>
+__attribute__((target("avx512f")))
+void Iterate(const double *cr, const double *ci, const KernelConfig &config, __mmask8 lanes, Escape *escapes) {
+  const __m512d bailout = _mm512_set1_pd(kBailout);
+  const __m512d two = _mm512_set1_pd(2.0);
+  const __m512d tolerance2 = _mm512_set1_pd(config.periodicity_tolerance * config.periodicity_tolerance);
+  const __m512i one = _mm512_set1_epi64(1);
+  const __m512d c_re = _mm512_maskz_loadu_pd(lanes, cr);
+  const __m512d c_im = _mm512_maskz_loadu_pd(lanes, ci);
+
+  __m512d zx = _mm512_setzero_pd(), zy = _mm512_setzero_pd();
+  __m512d zx2 = _mm512_setzero_pd(), zy2 = _mm512_setzero_pd();
+  __m512d norm = _mm512_setzero_pd();
+  __m512i it = _mm512_setzero_si512();
+  __mmask8 active = lanes;
+
+  __m512d sx = _mm512_setzero_pd(), sy = _mm512_setzero_pd();
+  __mmask8 periodic = 0;
+  __m512i period = _mm512_setzero_si512();
+  int saved = 0;
+  long long save_at = 1;
+
+  for (int i = 0; i < config.max_iterations; i++) {
+    __m512d current = _mm512_add_pd(zx2, zy2);
+    __mmask8 inside = _mm512_mask_cmp_pd_mask(active, current, bailout, _CMP_LE_OQ);
+    // Latch the norm of the lanes escaping now
+    norm = _mm512_mask_mov_pd(norm, active & ~inside, current);
+    active = inside;
+    if (active == 0)
+      break;
+
+    zy = _mm512_add_pd(_mm512_mul_pd(_mm512_mul_pd(two, zx), zy), c_im);
+    zx = _mm512_add_pd(_mm512_sub_pd(zx2, zy2), c_re);
+    zx2 = _mm512_mul_pd(zx, zx);
+    zy2 = _mm512_mul_pd(zy, zy);
+    it = _mm512_mask_add_epi64(it, active, it, one);
+
+    if constexpr (kPeriodicity) {
+      __m512d dx = _mm512_sub_pd(zx, sx), dy = _mm512_sub_pd(zy, sy);
+      __m512d distance2 = _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+      __mmask8 cycle = _mm512_mask_cmp_pd_mask(active, distance2, tolerance2, _CMP_LE_OQ);
+      if (cycle != 0) {
+        period = _mm512_mask_mov_epi64(period, cycle, _mm512_set1_epi64(i + 1 - saved));
+        periodic |= cycle;
+        active &= ~cycle;
+      }
+      if (i + 1 == save_at) {
+        sx = zx;
+        sy = zy;
+        saved = i + 1;
+        save_at *= 2;
+      }
+    }
+  }
+  // Lanes that ran out of budget
+  norm = _mm512_mask_mov_pd(norm, active, _mm512_add_pd(zx2, zy2));
+
+  alignas(64) double norms[kLanes];
+  alignas(64) long long its[kLanes], periods[kLanes];
+  _mm512_store_pd(norms, norm);
+  _mm512_store_si512(its, it);
+  _mm512_store_si512(periods, period);
+  for (int l = 0; l < kLanes; l++) {
+    if (!(lanes & (1 << l)))
+      continue;
+    if (periodic & (1 << l))
+      escapes[l] = {config.max_iterations, 0.0, static_cast<int>(periods[l])};
+    else
+      escapes[l] = {static_cast<int>(its[l]), norms[l]};
+  }
+}
+
+template <bool kPeriodicity>
+__attribute__((target("avx512f")))
+void Masked(const KernelConfig &config, const double *cr, const double *ci, int count, Escape *escapes) {
+  for (int i = 0; i < count; i += kLanes) {
+    int tail = std::min(count - i, kLanes);
+    Iterate<kPeriodicity>(cr + i, ci + i, config, static_cast<__mmask8>((1u << tail) - 1), escapes + i);
+  }
+}
+
+// Each lane follows its own Brent schedule, since lanes start their pixels
+// at different times.
+template <bool kPeriodicity>
+__attribute__((target("avx512f")))
+void Refill(const KernelConfig &config, const double *cr, const double *ci, int count, Escape *escapes) {
+  const __m512d bailout = _mm512_set1_pd(kBailout);
+  const __m512d two = _mm512_set1_pd(2.0);
+  const __m512d tolerance2 = _mm512_set1_pd(config.periodicity_tolerance * config.periodicity_tolerance);
+  const __m512i one = _mm512_set1_epi64(1);
+  const __m512i budget = _mm512_set1_epi64(config.max_iterations);
+  const __m512i lane_index = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+
+  // Pending pixels are consecutive in the queue, so expand loads hand them
+  // to the lanes that are done without leaving the registers. Lanes left
+  // without a pixel iterate c = 0 and are ignored.
+  int next = std::min(count, kLanes);
+  __mmask8 live = static_cast<__mmask8>((1u << next) - 1);
+  if (live == 0)
+    return;
+
+  __m512d c_re = _mm512_maskz_loadu_pd(live, cr), c_im = _mm512_maskz_loadu_pd(live, ci);
+  __m512i pixel = lane_index;
+  __m512d zx = _mm512_setzero_pd(), zy = _mm512_setzero_pd();
+  __m512d zx2 = _mm512_setzero_pd(), zy2 = _mm512_setzero_pd();
+  __m512i it = _mm512_setzero_si512();
+
+  __m512d sx = _mm512_setzero_pd(), sy = _mm512_setzero_pd();
+  __m512i saved = _mm512_setzero_si512(), save_at = one;
+  __mmask8 cycle = 0;
+  __m512i period = _mm512_setzero_si512();
+
+  while (true) {
+    // A pixel is done when it fails the bailout test, its budget is spent or
+    // its orbit closed a cycle on the last iteration
+    __m512d norm = _mm512_add_pd(zx2, zy2);
+    __mmask8 done = live & (_mm512_cmp_pd_mask(norm, bailout, _CMP_NLE_UQ) | _mm512_cmp_epi64_mask(it, budget, _MM_CMPINT_NLT) | cycle);
+
+    if (done != 0) {
+      alignas(64) double norms[kLanes];
+      alignas(64) long long its[kLanes], pixels[kLanes], periods[kLanes];
+      _mm512_store_pd(norms, norm);
+      _mm512_store_si512(its, it);
+      _mm512_store_si512(pixels, pixel);
+      _mm512_store_si512(periods, period);
+      for (unsigned lanes = done; lanes != 0; lanes &= lanes - 1) {
+        int l = __builtin_ctz(lanes);
+        if (cycle & (1 << l))
+          escapes[pixels[l]] = {config.max_iterations, 0.0, static_cast<int>(periods[l])};
+        else
+          escapes[pixels[l]] = {static_cast<int>(its[l]), norms[l]};
+      }
+
+      // Refill as many of the lanes as there are pending pixels
+      __mmask8 refill = 0;
+      for (unsigned lanes = done, pending = count - next; lanes != 0 && pending > 0; lanes &= lanes - 1, pending--)
+        refill |= lanes & -lanes;
+      __mmask8 retired = done & ~refill;
+
+      c_re = _mm512_maskz_mov_pd(~retired, _mm512_mask_expandloadu_pd(c_re, refill, cr + next));
+      c_im = _mm512_maskz_mov_pd(~retired, _mm512_mask_expandloadu_pd(c_im, refill, ci + next));
+      pixel = _mm512_mask_expand_epi64(pixel, refill, _mm512_add_epi64(_mm512_set1_epi64(next), lane_index));
+      next += __builtin_popcount(refill);
+
+      zx = _mm512_maskz_mov_pd(~done, zx);
+      zy = _mm512_maskz_mov_pd(~done, zy);
+      zx2 = _mm512_maskz_mov_pd(~done, zx2);
+      zy2 = _mm512_maskz_mov_pd(~done, zy2);
+      it = _mm512_maskz_mov_epi64(~done, it);
+      if constexpr (kPeriodicity) {
+        sx = _mm512_maskz_mov_pd(~done, sx);
+        sy = _mm512_maskz_mov_pd(~done, sy);
+        saved = _mm512_maskz_mov_epi64(~done, saved);
+        save_at = _mm512_mask_mov_epi64(save_at, done, one);
+        cycle &= ~done;
+      }
+
+      live &= ~retired;
+      if (live == 0)
+        break;
+      // Refilled pixels face the done test before their first iteration, as
+      // in the scalar loop, so a budget of 0 runs none
+      continue;
+    }
+
+    zy = _mm512_add_pd(_mm512_mul_pd(_mm512_mul_pd(two, zx), zy), c_im);
+    zx = _mm512_add_pd(_mm512_sub_pd(zx2, zy2), c_re);
+    zx2 = _mm512_mul_pd(zx, zx);
+    zy2 = _mm512_mul_pd(zy, zy);
+    it = _mm512_add_epi64(it, one);
+
+    if constexpr (kPeriodicity) {
+      __m512d dx = _mm512_sub_pd(zx, sx), dy = _mm512_sub_pd(zy, sy);
+      __m512d distance2 = _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+      cycle = _mm512_cmp_pd_mask(distance2, tolerance2, _CMP_LE_OQ);
+      period = _mm512_sub_epi64(it, saved);
+
+      __mmask8 save = _mm512_cmpeq_epi64_mask(it, save_at);
+      sx = _mm512_mask_mov_pd(sx, save, zx);
+      sy = _mm512_mask_mov_pd(sy, save, zy);
+      saved = _mm512_mask_mov_epi64(saved, save, it);
+      save_at = _mm512_mask_add_epi64(save_at, save, save_at, save_at);
+    }
+  }
+}
+
+};  // namespace
+
+void EscapeTimeAvx512(const KernelConfig &config, const double *cr, const double *ci, int count, Escape *escapes) {
+  if (config.periodicity_tolerance > 0)
+    Masked<true>(config, cr, ci, count, escapes);
+  else
+    Masked<false>(config, cr, ci, count, escapes);
+}
+
+void EscapeTimeRefillAvx512(const KernelConfig &config, const double *cr, const double *ci, int count, Escape *escapes) {
+  if (config.periodicity_tolerance > 0)
+    Refill<true>(config, cr, ci, count, escapes);
+  else
+    Refill<false>(config, cr, ci, count, escapes);
+}
+
+};  // namespace simd
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_X86_SIMD
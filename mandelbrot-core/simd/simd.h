@@ -0,0 +1,35 @@
+#ifndef MANDELBROT_CORE_SIMD_SIMD_H_
+#define MANDELBROT_CORE_SIMD_SIMD_H_
+
+#include "mandelbrot-core/kernel.h"
+
+// The vector kernels are compiled with per-function target attributes and
+// picked at runtime, so one binary runs everywhere.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MANDELBROT_X86_SIMD 1
+#else
+#define MANDELBROT_X86_SIMD 0
+#endif
+
+namespace mandelbrot {
+namespace simd {
+
+#if MANDELBROT_X86_SIMD
+
+// Masked kernels: every lane iterates until all of them have escaped or run
+// out of budget. `count` may be anything; the tail is padded internally.
+void EscapeTimeAvx2(const KernelConfig &config, const double *cr, const double *ci, int count, Escape *escapes);
+void EscapeTimeAvx512(const KernelConfig &config, const double *cr, const double *ci, int count, Escape *escapes);
+
+// Refill kernels: the batch is a queue, and a lane whose pixel is done
+// stores it and starts on the next pending one, so the vector stays full
+// until the queue runs dry.
+void EscapeTimeRefillAvx2(const KernelConfig &config, const double *cr, const double *ci, int count, Escape *escapes);
+void EscapeTimeRefillAvx512(const KernelConfig &config, const double *cr, const double *ci, int count, Escape *escapes);
+
+#endif
+
+};  // namespace simd
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_SIMD_SIMD_H_
@@ -0,0 +1,75 @@
+#include "mandelbrot-core/task_pool.h"
+
+#include <algorithm>
+
+namespace mandelbrot {
+
+TaskPool::TaskPool(int threads) {
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  // The caller of Run() is the first thread
+  for (int i = 1; i < threads; i++)
+    threads_.emplace_back(&TaskPool::WorkerLoop, this);
+}
+
+TaskPool::~TaskPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread &thread : threads_)
+    thread.join();
+}
+
+TaskPool &TaskPool::Shared() {
+  static TaskPool pool;
+  return pool;
+}
+
+void TaskPool::Run(int count, const std::function<void(int)> &work) {
+  if (threads_.empty() || count <= 1) {
+    for (int i = 0; i < count; i++)
+      work(i);
+    return;
+  }
+
+  Batch batch{&work, count};
+  std::unique_lock<std::mutex> lock(mutex_);
+  batches_.push_back(&batch);
+  wake_.notify_all();
+
+  while (batch.next < batch.count) {
+    int index = batch.next++;
+    if (batch.next == batch.count)
+      batches_.erase(std::find(batches_.begin(), batches_.end(), &batch));
+    lock.unlock();
+    work(index);
+    lock.lock();
+    batch.done++;
+  }
+  finished_.wait(lock, [&] { return batch.done == batch.count; });
+}
+
+void TaskPool::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [this] { return stop_ || !batches_.empty(); });
+    if (stop_)
+      return;
+
+    Batch &batch = *batches_.front();
+    int index = batch.next++;
+    if (batch.next == batch.count)
+      batches_.pop_front();
+    lock.unlock();
+    (*batch.work)(index);
+    lock.lock();
+    // The caller may return as soon as the last task is done
+    if (++batch.done == batch.count)
+      finished_.notify_all();
+  }
+}
+
+};  // namespace mandelbrot
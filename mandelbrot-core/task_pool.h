@@ -0,0 +1,59 @@
+#ifndef MANDELBROT_CORE_TASK_POOL_H_
+#define MANDELBROT_CORE_TASK_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mandelbrot {
+
+// Runs small batches of independent tasks, such as the partial products of
+// one multiplication, on threads that outlive them, so a reference orbit
+// does not start threads on every iteration. The calling thread works on
+// its own batch too, and a task may run a batch of its own: every thread
+// waits only for tasks some other thread is already running.
+class TaskPool {
+ public:
+  // `threads` counts the thread that calls Run(); 0 uses one per hardware
+  // thread.
+  explicit TaskPool(int threads = 0);
+  ~TaskPool();
+
+  TaskPool(const TaskPool &) = delete;
+  TaskPool &operator=(const TaskPool &) = delete;
+
+  // The pool the arbitrary precision arithmetic shares
+  static TaskPool &Shared();
+
+  int threads() const { return static_cast<int>(threads_.size()) + 1; }
+
+  // Calls `work` once for every index below `count`, from any of the
+  // threads, and returns when all of them are done.
+  void Run(int count, const std::function<void(int)> &work);
+
+ private:
+  struct Batch {
+    const std::function<void(int)> *work;
+    int count;
+    int next = 0;
+    int done = 0;
+  };
+
+  void WorkerLoop();
+
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable finished_;
+  // Batches with tasks nobody has taken yet, oldest first
+  std::deque<Batch *> batches_;
+  bool stop_ = false;
+};
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_TASK_POOL_H_
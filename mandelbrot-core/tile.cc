@@ -0,0 +1,18 @@
+#include "mandelbrot-core/tile.h"
+
+#include <algorithm>
+
+namespace mandelbrot {
+
+std::vector<Tile> SplitIntoTiles(int width, int height, int tile_size) {
+  tile_size = std::max(tile_size, 1);
+
+  std::vector<Tile> tiles;
+  for (int y = 0; y < height; y += tile_size) {
+    for (int x = 0; x < width; x += tile_size)
+      tiles.push_back({x, y, std::min(tile_size, width - x), std::min(tile_size, height - y)});
+  }
+  return tiles;
+}
+
+};  // namespace mandelbrot
@@ -0,0 +1,22 @@
+#ifndef MANDELBROT_CORE_TILE_H_
+#define MANDELBROT_CORE_TILE_H_
+
+#include <vector>
+
+namespace mandelbrot {
+
+// A rectangle of pixels, the unit of work handed to a thread.
+struct Tile {
+  int x;
+  int y;
+  int width;
+  int height;
+};
+
+// Covers a width x height image with tiles of at most tile_size x tile_size
+// pixels, row by row from the bottom left.
+std::vector<Tile> SplitIntoTiles(int width, int height, int tile_size);
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_TILE_H_
@@ -0,0 +1,48 @@
+#ifndef MANDELBROT_CORE_VIEWPORT_H_
+#define MANDELBROT_CORE_VIEWPORT_H_
+
+namespace mandelbrot {
+
+// A point of the complex plane.
+struct Complex {
+  double re;
+  double im;
+};
+
+// Left-bottom and right-top corners of the rendered region, laid out like
+// the `lbrt` uniform of mandelbrot.frag.
+struct Viewport {
+  double left;
+  double bottom;
+  double right;
+  double top;
+
+  // Maps canvas coordinates (the `fragmentCoords` of the shader) to the
+  // complex plane.
+  Complex At(double u, double v) const {
+    return {left + (right - left) * u, bottom + (top - bottom) * v};
+  }
+
+  friend bool operator==(const Viewport &a, const Viewport &b) = default;
+};
+
+// Canvas coordinates of the center of pixel (x, y) in a width x height
+// image. As with the canvas quad drawn by mandelbrot-set, v spans [0, 1]
+// bottom to top and u is widened around 0.5 by the aspect ratio, so the
+// image is never stretched.
+inline void PixelToCanvas(int x, int y, int width, int height, double &u, double &v) {
+  double ar = static_cast<double>(width) / static_cast<double>(height);
+  u = 0.5 + ((x + 0.5) / width - 0.5) * ar;
+  v = (y + 0.5) / height;
+}
+
+// The inverse of PixelToCanvas(), in fractional pixels.
+inline void CanvasToPixel(double u, double v, int width, int height, double &x, double &y) {
+  double ar = static_cast<double>(width) / static_cast<double>(height);
+  x = ((u - 0.5) / ar + 0.5) * width - 0.5;
+  y = v * height - 0.5;
+}
+
+};  // namespace mandelbrot
+
+#endif  // MANDELBROT_CORE_VIEWPORT_H_
@@ -1,25 +1,141 @@
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <optional>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
 
+#include "mandelbrot-core/double_double.h"
+#include "mandelbrot-core/frame_pacer.h"
+#include "mandelbrot-core/iteration_control.h"
+#include "mandelbrot-core/perturbation.h"
+#include "mandelbrot-core/precision.h"
+#include "mandelbrot-core/progressive.h"
+#include "mandelbrot-core/resolution.h"
+#include "mandelbrot-core/reprojection.h"
+#include "mandelbrot-core/scheduler.h"
+#include "mandelbrot-set/wrapper/framebuffer.h"
+#include "mandelbrot-set/wrapper/histogram.h"
 #include "mandelbrot-set/wrapper/shader.h"
+#include "mandelbrot-set/wrapper/timer.h"
 
 #define WIDTH 800
 #define HEIGHT 600
 
+// Skip the main cardioid and the period-2 bulb (toggled with C)
+bool cardioidCheck = true;
+// Hold the view while maxIt keeps rising (toggled with Space)
+bool paused = false;
+// Carry deep frames over to the next one, rendering only what moved too far
+// (toggled with R)
+bool reprojection = false;
+// Render frames coarse to fine within a time budget, carrying the rest over
+// to the next frame (toggled with P)
+bool progressive = false;
+// Render at a lower resolution when frames run over their target time
+// (toggled with D)
+bool dynamicResolution = false;
+// Pick maxIt from the escape counts of the last frame instead of raising it
+// steadily (toggled with I)
+bool adaptiveIterations = false;
+// Color interior pixels by the period of the cycle they settled into
+// (toggled with O)
+bool colorPeriods = false;
+
 void FramebufferSizeCallback(GLFWwindow *window, int width, int height) {
   glViewport(0, 0, width, height);
 }
 
-int main() {
+void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods) {
+  if (key == GLFW_KEY_C && action == GLFW_PRESS)
+    cardioidCheck = !cardioidCheck;
+  if (key == GLFW_KEY_SPACE && action == GLFW_PRESS)
+    paused = !paused;
+  if (key == GLFW_KEY_R && action == GLFW_PRESS)
+    reprojection = !reprojection;
+  if (key == GLFW_KEY_P && action == GLFW_PRESS)
+    progressive = !progressive;
+  if (key == GLFW_KEY_D && action == GLFW_PRESS)
+    dynamicResolution = !dynamicResolution;
+  if (key == GLFW_KEY_I && action == GLFW_PRESS)
+    adaptiveIterations = !adaptiveIterations;
+  if (key == GLFW_KEY_O && action == GLFW_PRESS)
+    colorPeriods = !colorPeriods;
+}
+
+int main(int argc, char **argv) {
+  // How to shade views doubles can resolve: "double", "float-float" for GPUs
+  // whose fp64 is crippled, or "auto" to time every shader at startup and
+  // rank them by speed
+  std::string shading = "double";
+  // Point to zoom into, "<re>,<im>" in decimal with as many digits as needed
+  std::string target = "0.36024044343761436323,-0.64131306106480317486";
+  // Time a progressive frame may take, in seconds; by default three
+  // quarters of the period the loop is paced at, leaving the rest to
+  // coloring and the swap
+  double frameBudget = 0.0;
+  // Frame time dynamic resolution aims for, in seconds, by default the
+  // period the loop is paced at, and the smallest fraction of the window
+  // size along each side it may render at
+  double targetFrameTime = 0.0;
+  double minResolution = 0.25;
+  // Fraction of the escaping pixels adaptive maxIt may leave unresolved
+  double unresolvedFraction = 0.001;
+  // Frames per second to pace the loop at, 0 for as fast as it goes, and
+  // whether buffer swaps also wait for the display
+  double frameRateLimit = 144.0;
+  bool vsync = false;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg.rfind("--shader=", 0) == 0)
+      shading = arg.substr(9);
+    else if (arg.rfind("--destination=", 0) == 0)
+      target = arg.substr(14);
+    else if (arg.rfind("--frame-budget=", 0) == 0)
+      frameBudget = std::stod(arg.substr(15)) / 1000.0;
+    else if (arg.rfind("--target-frame-time=", 0) == 0) {
+      targetFrameTime = std::stod(arg.substr(20)) / 1000.0;
+      dynamicResolution = true;
+    } else if (arg.rfind("--min-resolution=", 0) == 0)
+      minResolution = std::stod(arg.substr(17));
+    else if (arg.rfind("--unresolved-fraction=", 0) == 0) {
+      unresolvedFraction = std::stod(arg.substr(22));
+      adaptiveIterations = true;
+    } else if (arg.rfind("--fps=", 0) == 0)
+      frameRateLimit = std::stod(arg.substr(6));
+    else if (arg == "--vsync")
+      vsync = true;
+  }
+  double framePeriod = 1.0 / (frameRateLimit > 0.0 ? frameRateLimit : 60.0);
+  if (frameBudget <= 0.0)
+    frameBudget = 0.75 * framePeriod;
+  if (targetFrameTime <= 0.0)
+    targetFrameTime = framePeriod;
+  if (shading != "double" && shading != "float-float" && shading != "auto") {
+    std::cout << "Unknown shader \"" << shading << "\", expected double, float-float or auto" << std::endl;
+    return -1;
+  }
+  size_t comma = target.find(',');
+  std::optional<mandelbrot::FixedComplex> exactDestination;
+  if (comma != std::string::npos)
+    exactDestination = mandelbrot::FixedComplex::Parse(std::string_view(target).substr(0, comma), std::string_view(target).substr(comma + 1));
+  if (!exactDestination) {
+    std::cout << "Invalid destination \"" << target << "\", expected <re>,<im> in decimal" << std::endl;
+    return -1;
+  }
+
   // Initialize glfw
   glfwInit();
-  glfwWindowHint(GLFW_SAMPLES, 4);  // 4x antialiasing
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -32,9 +148,12 @@ int main() {
     return -1;
   }
   glfwMakeContextCurrent(window);
+  // The frame pacer alone sets the rate unless asked to follow the display
+  glfwSwapInterval(vsync ? 1 : 0);
 
   // Set glfw callbacks to handle IO events
   glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+  glfwSetKeyCallback(window, KeyCallback);
 
   // Load opengl functions
   if (!gladLoadGL((GLADloadfunc) glfwGetProcAddress)) {
@@ -49,8 +168,14 @@ int main() {
   glEnable(GL_DEPTH_TEST);
   glDepthFunc(GL_LESS);
 
-    // Store time to measure framerate
-    double lastTime = glfwGetTime();
+  // The canvas covers the whole window, so multisampling has nothing to
+  // smooth, and without it every pixel is shaded exactly once, as the pixel
+  // state of the shaders needs. The window asks for no samples either: the
+  // offscreen target could not be stretched onto a multisampled one.
+  glDisable(GL_MULTISAMPLE);
+
+    // Sleeps until each frame is due and measures how late frames start
+    mandelbrot::FramePacer pacer(frameRateLimit);
     long int frameCount = 0;
 
     /*********
@@ -97,6 +222,14 @@ int main() {
     **********/
     // Create and compile our GLSL program from the shaders
     opengl::Shader shader("mandelbrot-set/shaders/mandelbrot.vert", "mandelbrot-set/shaders/mandelbrot.frag");
+    // The same in float, for shallow views
+    opengl::Shader floatShader("mandelbrot-set/shaders/mandelbrot.vert", "mandelbrot-set/shaders/float.frag");
+    // The same without doubles, in float-float
+    opengl::Shader floatFloatShader("mandelbrot-set/shaders/mandelbrot.vert", "mandelbrot-set/shaders/float_float.frag");
+    // Past the precision of doubles, the same in double-double
+    opengl::Shader doubleDoubleShader("mandelbrot-set/shaders/mandelbrot.vert", "mandelbrot-set/shaders/double_double.frag");
+    // Colors iteration counts computed on the CPU
+    opengl::Shader iterationShader("mandelbrot-set/shaders/mandelbrot.vert", "mandelbrot-set/shaders/iterations.frag");
 
     /***********
     * TEXTURES *
@@ -121,36 +254,312 @@ int main() {
     };
     glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB, textureWidth, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
 
+    // Iteration counts of the CPU renderers, one texel per pixel
+    glActiveTexture(GL_TEXTURE1);
+    GLuint iterationTexture;
+    glGenTextures(1, &iterationTexture);
+    glBindTexture(GL_TEXTURE_2D, iterationTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    std::vector<float> iterations;
+
+    /**************
+    * PIXEL STATE *
+    **************/
+    // (z, it) of every pixel for float.frag and mandelbrot.frag, a PixelState
+    // of 32 bytes each, so frames of an unchanged view resume where the last
+    // one stopped
+    const GLsizeiptr pixelStateBytes = 32;
+    GLuint stateBuffer;
+    glGenBuffers(1, &stateBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, stateBuffer);
+    int stateWidth = 0, stateHeight = 0;
+    auto resizeState = [&](int width, int height) {
+        if (width == stateWidth && height == stateHeight)
+            return;
+        stateWidth = width;
+        stateHeight = height;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, stateBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, pixelStateBytes * width * height, nullptr, GL_DYNAMIC_COPY);
+    };
+    // What the state holds; any change to it restarts every pixel
+    bool stateValid = false;
+    bool resumeState = false;
+    glm::dvec4 stateView;
+    mandelbrot::Precision statePrecision = mandelbrot::Precision::kFloat;
+    bool stateCardioidCheck = false;
+    float stateMaxIt = 0.0f;
+
+    /************
+    * HISTOGRAM *
+    ************/
+    // Escape counts of the last frame, counted by the shaders into a buffer
+    // read back a frame later or by the CPU after a deep frame, and the
+    // maxIt and time the frame was rendered with
+    opengl::HistogramBuffer histogram(mandelbrot::kHistogramBins, 1);
+    std::array<float, opengl::HistogramBuffer::kSpans> countedMaxIt{};
+    std::vector<uint32_t> escapes;
+    bool escapesReady = false;
+    float escapesMaxIt = 0.0f;
+    double escapesSeconds = 0.0;
+
+    /******
+    * CPU *
+    ******/
+    // Past the precision of double-double frames are rendered by perturbation
+    mandelbrot::TileScheduler scheduler;
+    mandelbrot::PerturbationRenderer perturbation;
+    // The offsets of the last deep frame, to reproject it from
+    mandelbrot::Reprojector reprojector;
+    mandelbrot::ReprojectionStats reprojectionStats{};
+    // Deep frames refined over the frames after them
+    mandelbrot::ProgressiveRenderer progressiveRenderer;
+    mandelbrot::ProgressiveStats progressiveStats{};
+    bool reprojectable = false;
+    glm::dvec2 reprojectedLeftBottom, reprojectedRightTop;
+    int64_t reprojectedExponent = 0;
+
     /*******
     * ZOOM *
     *******/
     // Left-Bottom, Right-Top and Destination coordinates
-    glm::dvec2 left_bottom(-2.0, -2.0), right_top(2.0, 2.0), destination(0.36024044343761436323, -0.64131306106480317486);
+    glm::dvec2 left_bottom(-2.0, -2.0), right_top(2.0, 2.0), destination(exactDestination->re.ToDouble(), exactDestination->im.ToDouble());
+    // Every digit of the destination, for double-double and perturbation
+    mandelbrot::DoubleDouble destinationRe = mandelbrot::DoubleDouble::From(exactDestination->re);
+    mandelbrot::DoubleDouble destinationIm = mandelbrot::DoubleDouble::From(exactDestination->im);
     glm::dvec4 left_bottom_right_top(left_bottom, right_top);
+    // Corners relative to the destination, which keep their precision at any zoom
+    glm::dvec2 left_bottom_offset = left_bottom - destination, right_top_offset = right_top - destination;
+    // The offsets are scaled by 2^offsetExponent, rescaled whenever they get
+    // small, so they outlast the 1e-308 of doubles
+    int64_t offsetExponent = 0;
     // Zoom per second and Total zoom
     double zoom = 1.25;
-    double totalZoom = 1;
+    mandelbrot::FloatExp totalZoom = 1.0;
     // Color period and Max iterations
     float colorPeriod = 100.0f;
     float maxIt = 1.0f;
+    // Brent's cycle detection radius of the GPU kernels, a thousandth of the
+    // pixel spacing as in RenderParams::periodicity_tolerance
+    float periodicityTolerance = 0.0f;
+    // Kernel of the last frame, and how perturbation went if it was used
+    mandelbrot::Precision precision = mandelbrot::Precision::kFloat;
+    mandelbrot::PerturbationStats deepStats{};
 
-    while (!glfwWindowShouldClose(window)) {
-        // Measure speed
-        double currentTime = glfwGetTime();
-        double frameLatency = (currentTime - lastTime);
-        double frameRate = 1. / frameLatency;
+    /**********
+    * SHADING *
+    **********/
+    // Set up a shader for the current view, which doubles can resolve
+    auto useDoubleShader = [&](const glm::mat4 &mvp, float iterations) {
+        shader.Use();
+        shader.SetUniform("mvp", mvp);
+        shader.SetUniform("lbrt", left_bottom_right_top);
+        shader.SetUniform("colorPeriod", colorPeriod);
+        shader.SetUniform("maxIt", iterations);
+        shader.SetUniform("cardioidCheck", cardioidCheck);
+        shader.SetUniform("colormap", 0);
+        shader.SetUniform("countEscapes", adaptiveIterations);
+        shader.SetUniform("periodicityTolerance", periodicityTolerance);
+        shader.SetUniform("colorPeriods", colorPeriods);
+        shader.SetUniform("resume", resumeState);
+        shader.SetUniform("stateWidth", stateWidth);
+    };
+    auto useFloatShader = [&](const glm::mat4 &mvp, float iterations) {
+        floatShader.Use();
+        floatShader.SetUniform("mvp", mvp);
+        floatShader.SetUniform("lbrt", glm::vec4(left_bottom_right_top));
+        floatShader.SetUniform("colorPeriod", colorPeriod);
+        floatShader.SetUniform("maxIt", iterations);
+        floatShader.SetUniform("cardioidCheck", cardioidCheck);
+        floatShader.SetUniform("colormap", 0);
+        floatShader.SetUniform("countEscapes", adaptiveIterations);
+        floatShader.SetUniform("periodicityTolerance", periodicityTolerance);
+        floatShader.SetUniform("colorPeriods", colorPeriods);
+        floatShader.SetUniform("resume", resumeState);
+        floatShader.SetUniform("stateWidth", stateWidth);
+    };
+    auto useFloatFloatShader = [&](const glm::mat4 &mvp, float iterations) {
+        // Each coordinate as the nearest float plus the nearest float to the rest
+        glm::vec2 hi(left_bottom);
+        glm::vec2 lo(left_bottom - glm::dvec2(hi));
+        floatFloatShader.Use();
+        floatFloatShader.SetUniform("mvp", mvp);
+        floatFloatShader.SetUniform("leftBottom", glm::vec4(hi.x, lo.x, hi.y, lo.y));
+        floatFloatShader.SetUniform("size", glm::vec2(right_top - left_bottom));
+        floatFloatShader.SetUniform("colorPeriod", colorPeriod);
+        floatFloatShader.SetUniform("maxIt", iterations);
+        floatFloatShader.SetUniform("cardioidCheck", cardioidCheck);
+        floatFloatShader.SetUniform("colormap", 0);
+        floatFloatShader.SetUniform("countEscapes", adaptiveIterations);
+        floatFloatShader.SetUniform("periodicityTolerance", periodicityTolerance);
+        floatFloatShader.SetUniform("colorPeriods", colorPeriods);
+    };
+    auto useDoubleDoubleShader = [&](const glm::mat4 &mvp, float iterations) {
+        doubleDoubleShader.Use();
+        doubleDoubleShader.SetUniform("mvp", mvp);
+        doubleDoubleShader.SetUniform("center", glm::dvec4(destinationRe.hi, destinationIm.hi, destinationRe.lo, destinationIm.lo));
+        doubleDoubleShader.SetUniform("lbrt", glm::dvec4(left_bottom_offset, right_top_offset));
+        doubleDoubleShader.SetUniform("colorPeriod", colorPeriod);
+        doubleDoubleShader.SetUniform("maxIt", iterations);
+        doubleDoubleShader.SetUniform("cardioidCheck", cardioidCheck);
+        doubleDoubleShader.SetUniform("colormap", 0);
+        doubleDoubleShader.SetUniform("countEscapes", adaptiveIterations);
+        doubleDoubleShader.SetUniform("periodicityTolerance", periodicityTolerance);
+        doubleDoubleShader.SetUniform("colorPeriods", colorPeriods);
+    };
+
+    // GPU kernels cheapest first; the planner falls back on perturbation
+    std::vector<mandelbrot::Precision> ranking = {mandelbrot::Precision::kFloat, mandelbrot::Precision::kDouble, mandelbrot::Precision::kDoubleDouble};
+    if (shading == "float-float")
+        ranking.insert(ranking.begin() + 1, mandelbrot::Precision::kFloatFloat);
+
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    resizeState(framebufferWidth, framebufferHeight);
+
+    if (shading == "auto") {
+        // Time every shader on the starting view and rank them by speed
+        GLuint query;
+        glGenQueries(1, &query);
+        auto timeShader = [&](const auto &use) {
+            const int frames = 8;
+            glBindTexture(GL_TEXTURE_1D, texture);
+            glBindVertexArray(canvasVertexArrayID);
+            use(glm::mat4(1.0f), 1000.0f);
+            glBeginQuery(GL_TIME_ELAPSED, query);
+            for (int i = 0; i < frames; i++)
+                glDrawElements(GL_TRIANGLES, 2 * 3, GL_UNSIGNED_INT, 0);
+            glEndQuery(GL_TIME_ELAPSED);
+            glBindVertexArray(0);
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+            return nanoseconds / 1e6 / frames;
+        };
+        double floatMs = timeShader(useFloatShader);
+        double floatFloatMs = timeShader(useFloatFloatShader);
+        double doubleMs = timeShader(useDoubleShader);
+        double doubleDoubleMs = timeShader(useDoubleDoubleShader);
+        glDeleteQueries(1, &query);
+        std::cout << "Shader benchmark: float " << floatMs << " ms, float-float " << floatFloatMs << " ms, double " << doubleMs << " ms, double-double " << doubleDoubleMs << " ms per frame" << std::endl;
+
+        // Only the ranking matters: each kernel still only runs where it
+        // resolves the view
+        std::vector<std::pair<double, mandelbrot::Precision>> timed = {
+            {floatMs, mandelbrot::Precision::kFloat},
+            {floatFloatMs, mandelbrot::Precision::kFloatFloat},
+            {doubleMs, mandelbrot::Precision::kDouble},
+            {doubleDoubleMs, mandelbrot::Precision::kDoubleDouble},
+        };
+        std::sort(timed.begin(), timed.end());
+        ranking.clear();
+        for (const auto &[ms, kernel] : timed)
+            ranking.push_back(kernel);
+    }
+    mandelbrot::PrecisionPlanner planner(ranking);
+
+    // Render time of every frame, on the GPU and for perturbation on the
+    // CPU, which the planner weighs its switches by. GPU times come back
+    // frames late, so what each frame in flight was rendered with is kept
+    // by its span of the timer.
+    opengl::GpuTimer gpuTimer;
+    double cpuSeconds = 0.0;
+    struct TimedFrame {
+        mandelbrot::Precision precision;
+        double cpuSeconds;
+        double scale;
+        // Grid step the frame was drawn at, 0 if it drew nothing
+        int step;
+    };
+    std::array<TimedFrame, opengl::GpuTimer::kSpans> inFlight{};
+    // Time of the last timed frame as if it drew every pixel, which the
+    // progressive GPU frames pick their grid by
+    double fullFrameSeconds = 0.0;
+
+    // Offscreen target of dynamic resolution, sized by the controller from
+    // the same frame times
+    opengl::Framebuffer offscreen;
+    mandelbrot::ResolutionController resolution(targetFrameTime, minResolution);
+    bool resolutionActive = false;
+
+    // Progressive GPU frames draw the canvas on the same grids as the CPU,
+    // every 8th, 4th and 2nd pixel of every such row, then all of them, each
+    // grid into a target of its own, and show the finest grid drawn for the
+    // view stretched over the window until the next one is complete
+    std::array<opengl::Framebuffer, 4> grids;
+    // Finest grid step drawn, 0 for none, and what it was drawn for
+    int gridStep = 0;
+    glm::dvec4 gridView(0.0);
+    mandelbrot::Precision gridPrecision = mandelbrot::Precision::kFloat;
+    bool gridCardioidCheck = false, gridColorPeriods = false;
+    float gridMaxIt = 0.0f;
+    int gridWidth = 0, gridHeight = 0;
+    // The target of a grid step, steps being powers of two
+    auto gridFor = [&](int step) -> opengl::Framebuffer & {
+        int level = 0;
+        while ((1 << level) < step)
+            level++;
+        return grids[level];
+    };
 
-        // Fix framerate
-        if (frameRate > 144)
-            continue;
+    // Adaptive maxIt, held to the same frame time
+    mandelbrot::IterationController iterationController(unresolvedFraction, targetFrameTime);
+    mandelbrot::IterationController::Decision iterationDecision{maxIt, 0.0, false};
+    float loggedMaxIt = 0.0f;
+    bool loggedCapped = false;
 
-        // Update timing variables
-        lastTime = currentTime;
+    while (!glfwWindowShouldClose(window)) {
+        // Wait for the frame to be due and measure speed
+        double frameLatency = pacer.Wait();
+        double frameRate = frameLatency > 0.0 ? 1. / frameLatency : 0.0;
         frameCount++;
 
+        // Log kernel switches once the frames after them are timed
+        double gpuSeconds;
+        long timedSpan;
+        while (gpuTimer.Read(gpuSeconds, timedSpan)) {
+            const TimedFrame &timed = inFlight[timedSpan % opengl::GpuTimer::kSpans];
+            if (timed.step == 0)
+                continue;
+            // A grid of step s drew one pixel in s * s
+            double frameSeconds = timed.cpuSeconds + timed.step * timed.step * gpuSeconds;
+            fullFrameSeconds = frameSeconds;
+            planner.Record(timed.precision, frameSeconds);
+            // Frames of another scale say nothing about this one
+            if (dynamicResolution && resolutionActive && timed.scale == resolution.scale())
+                resolution.Record(frameSeconds);
+            escapesSeconds = frameSeconds;
+        }
+        // The newest finished counts win
+        long countedSpan;
+        while (histogram.Read(escapes, countedSpan)) {
+            escapesReady = true;
+            escapesMaxIt = countedMaxIt[countedSpan % opengl::HistogramBuffer::kSpans];
+        }
+        // Back to full resolution whenever it is switched on again
+        if (dynamicResolution != resolutionActive) {
+            resolution.Reset();
+            resolutionActive = dynamicResolution;
+        }
+        while (std::optional<mandelbrot::PrecisionPlanner::Transition> transition = planner.PopTransition())
+            std::cout << "Precision: " << mandelbrot::PrecisionName(transition->from) << " -> " << mandelbrot::PrecisionName(transition->to) << " at pixel spacing " << transition->spacing << ", frame time " << transition->before_seconds * 1000 << " ms -> " << transition->after_seconds * 1000 << " ms" << std::endl;
+
         // Update window title
         std::stringstream ss;
-        ss << "FPS: " << frameRate << " -- Latency: " << frameLatency << " -- Frame count: " << frameCount << " -- Current zoom: " << totalZoom << " -- Max iterations: " << static_cast<int>(maxIt);
+        ss << "FPS: " << frameRate << " -- Latency: " << frameLatency << " -- Frame count: " << frameCount << " -- Current zoom: " << totalZoom << " -- Max iterations: " << static_cast<int>(maxIt) << " -- Cardioid check: " << (cardioidCheck ? "on" : "off") << " -- Precision: " << mandelbrot::PrecisionName(precision) << (resumeState ? " (resumed)" : "") << (paused ? " -- Paused" : "");
+        if (precision >= mandelbrot::Precision::kPerturbation)
+            ss << " -- Perturbation: reference " << deepStats.reference_length << " (" << deepStats.reference_seconds * 1000 << " ms), pixels " << deepStats.render_seconds * 1000 << " ms, series skip " << deepStats.series_skip << " (" << deepStats.saved_seconds * 1000 << " ms saved), BLA " << deepStats.bla_bytes / 1024 << " KiB in " << deepStats.bla_seconds * 1000 << " ms (x" << deepStats.bla_speedup << "), " << deepStats.rebases << " rebases, passes " << deepStats.passes << " (" << deepStats.glitched << " glitched, " << deepStats.unresolved << " unresolved)";
+        if (precision >= mandelbrot::Precision::kPerturbation && progressive)
+            ss << " -- Progressive: " << progressiveStats.coverage * 100 << "% rendered, 1/" << progressiveStats.step * progressiveStats.step << " grid complete" << (progressiveStats.complete ? "" : " (refining)");
+        else if (progressive)
+            ss << " -- Progressive: 1/" << gridStep * gridStep << " grid complete, " << fullFrameSeconds * 1000 << " ms per full frame for " << frameBudget * 1000 << " ms";
+        else if (precision >= mandelbrot::Precision::kPerturbation && reprojection)
+            ss << " -- Reprojection: " << reprojectionStats.reuse_rate * 100 << "% reused (" << reprojectionStats.rendered << " rendered, " << reprojectionStats.refined << " refined)";
+        if (dynamicResolution)
+            ss << " -- Resolution: " << resolution.scale() * 100 << "% (" << resolution.Scaled(framebufferWidth) << "x" << resolution.Scaled(framebufferHeight) << ", " << resolution.mean_seconds() * 1000 << " ms for " << resolution.target_seconds() * 1000 << " ms)";
+        if (adaptiveIterations)
+            ss << " -- Adaptive maxIt: " << iterationDecision.unresolved * 100 << "% unresolved" << (iterationDecision.capped ? " (capped by frame time)" : "");
+        if (pacer.target_rate() > 0.0)
+            ss << " -- Pacing: " << pacer.target_rate() << " fps, jitter " << pacer.stats().jitter * 1000 << " ms (worst " << pacer.stats().worst_jitter * 1000 << " ms), " << pacer.stats().late * 100 << "% late";
         glfwSetWindowTitle(window, ss.str().c_str());
 
         /******
@@ -177,35 +586,206 @@ int main() {
         /*********
         * RENDER *
         *********/
+        // Frames are drawn offscreen at the resolution the controller
+        // settled on, then stretched over the window
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        int renderWidth = framebufferWidth, renderHeight = framebufferHeight;
+        if (dynamicResolution) {
+            renderWidth = resolution.Scaled(framebufferWidth);
+            renderHeight = resolution.Scaled(framebufferHeight);
+        }
+
+        // Take the cheapest kernel that still tells pixels apart
+        mandelbrot::FloatExp spacing = mandelbrot::FloatExp((right_top_offset.y - left_bottom_offset.y) / renderHeight, offsetExponent);
+        mandelbrot::FloatExp radius = mandelbrot::FloatExp(std::max(glm::length(left_bottom_offset), glm::length(right_top_offset)), offsetExponent);
+        double magnitude = std::hypot(destination.x, destination.y);
+        precision = planner.Plan(spacing, magnitude, radius);
+        periodicityTolerance = static_cast<float>(1e-3 * spacing.ToDouble());
+
+        // Progressive GPU frames start a new view on the finest grid the
+        // budget allows, or the coarsest, and refine a view they already
+        // drew the same way; a drawn view only needs redrawing in full for
+        // a new maxIt
+        bool gridded = progressive && precision < mandelbrot::Precision::kPerturbation;
+        int drawStep = 1;
+        if (gridded) {
+            bool sameView = gridStep > 0 && gridView == left_bottom_right_top && gridPrecision == precision && gridCardioidCheck == cardioidCheck && gridColorPeriods == colorPeriods && gridWidth == renderWidth && gridHeight == renderHeight;
+            int coarsest = sameView ? gridStep / 2 : mandelbrot::ProgressiveRenderer::kCoarsestStep;
+            drawStep = coarsest;
+            for (int step = 1; step < coarsest; step *= 2) {
+                if (fullFrameSeconds / (step * step) <= frameBudget) {
+                    drawStep = step;
+                    break;
+                }
+            }
+            if (sameView && gridStep == 1)
+                drawStep = gridMaxIt != maxIt ? 1 : 0;
+        }
+
+        if (gridded && drawStep > 0) {
+            // Every grid of the view is drawn in full before it is shown,
+            // so nothing of an older view or size shows through
+            opengl::Framebuffer &grid = gridFor(drawStep);
+            grid.Resize((renderWidth + drawStep - 1) / drawStep, (renderHeight + drawStep - 1) / drawStep);
+            grid.Bind();
+        } else if (!gridded && dynamicResolution) {
+            offscreen.Resize(renderWidth, renderHeight);
+            offscreen.Bind();
+        }
+
         // Clear the color buffer
         glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // Use our shader
-        shader.Use();
+        // Pick up the pixels of the last frame where it left them if only
+        // maxIt changed since; coarser grids keep none
+        bool stateful = precision == mandelbrot::Precision::kFloat || precision == mandelbrot::Precision::kDouble;
+        resumeState = stateful && drawStep == 1 && stateValid && stateView == left_bottom_right_top && statePrecision == precision && stateCardioidCheck == cardioidCheck && stateMaxIt <= maxIt && stateWidth == renderWidth && stateHeight == renderHeight;
+        if (stateful)
+            resizeState(renderWidth, renderHeight);
 
-        // Draw canvas
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_1D, texture);
         glBindVertexArray(canvasVertexArrayID);
-        shader.SetUniform("mvp", mvp);
-        shader.SetUniform("lbrt", left_bottom_right_top);
-        shader.SetUniform("colorPeriod", colorPeriod);
-        shader.SetUniform("maxIt", maxIt);
-        shader.SetUniform("colormap", 0);
-        glDrawElements(GL_TRIANGLES, 2 * 3, GL_UNSIGNED_INT, 0);
+
+        long span = gpuTimer.Begin();
+        cpuSeconds = 0.0;
+        if (precision >= mandelbrot::Precision::kPerturbation) {
+            // Render the iterations on the CPU and color them on the GPU
+            int limbs = mandelbrot::FixedPoint::FractionLimbsFor(spacing);
+            mandelbrot::PerturbationParams params{
+                {
+                    exactDestination->WithFractionLimbs(limbs),
+                    {left_bottom_offset.x, left_bottom_offset.y, right_top_offset.x, right_top_offset.y},
+                    offsetExponent,
+                },
+                maxIt,
+            };
+            iterations.resize(static_cast<size_t>(renderWidth) * renderHeight);
+            mandelbrot::IterationBuffer buffer{iterations.data(), renderWidth, renderHeight};
+            double renderStart = glfwGetTime();
+            if (progressive) {
+                progressiveStats = progressiveRenderer.Render(params, buffer, scheduler, frameBudget);
+                deepStats = progressiveStats.last;
+            } else {
+                if (reprojection) {
+                    // Both views at the scale of the current offsets
+                    if (!reprojectable)
+                        reprojector.Reset();
+                    double rescale = std::ldexp(1.0, static_cast<int>(reprojectedExponent - offsetExponent));
+                    glm::dvec2 lastLeftBottom = reprojectedLeftBottom * rescale, lastRightTop = reprojectedRightTop * rescale;
+                    reprojectionStats = reprojector.Reproject({lastLeftBottom.x, lastLeftBottom.y, lastRightTop.x, lastRightTop.y}, params.lbrt.offset, mandelbrot::MaxIterations(maxIt), buffer);
+                    params.mask = reprojector.mask().data();
+                }
+                deepStats = perturbation.Render(params, buffer, scheduler);
+            }
+            cpuSeconds = glfwGetTime() - renderStart;
+            if (adaptiveIterations) {
+                escapes.assign(mandelbrot::kHistogramBins, 0);
+                mandelbrot::CountEscapes(buffer, escapes);
+                escapesReady = true;
+                escapesMaxIt = maxIt;
+                escapesSeconds = cpuSeconds;
+            }
+            reprojectedLeftBottom = left_bottom_offset;
+            reprojectedRightTop = right_top_offset;
+            reprojectedExponent = offsetExponent;
+
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, iterationTexture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, renderWidth, renderHeight, 0, GL_RED, GL_FLOAT, iterations.data());
+
+            iterationShader.Use();
+            iterationShader.SetUniform("mvp", mvp);
+            iterationShader.SetUniform("colorPeriod", colorPeriod);
+            iterationShader.SetUniform("colormap", 0);
+            iterationShader.SetUniform("iterations", 1);
+        } else if (precision == mandelbrot::Precision::kDoubleDouble) {
+            useDoubleDoubleShader(mvp, maxIt);
+        } else if (precision == mandelbrot::Precision::kFloatFloat) {
+            useFloatFloatShader(mvp, maxIt);
+        } else if (precision == mandelbrot::Precision::kFloat) {
+            useFloatShader(mvp, maxIt);
+        } else {
+            // Use our shader
+            useDoubleShader(mvp, maxIt);
+        }
+        // The GPU kernels count escapes as they draw
+        bool countEscapes = adaptiveIterations && precision < mandelbrot::Precision::kPerturbation && drawStep > 0;
+        if (countEscapes)
+            countedMaxIt[histogram.Begin() % opengl::HistogramBuffer::kSpans] = maxIt;
+        // Draw canvas
+        if (drawStep > 0)
+            glDrawElements(GL_TRIANGLES, 2 * 3, GL_UNSIGNED_INT, 0);
         glBindVertexArray(0);
+        if (countEscapes)
+            histogram.End();
+        gpuTimer.End();
+        inFlight[span % opengl::GpuTimer::kSpans] = {precision, cpuSeconds, dynamicResolution ? resolution.scale() : 1.0, drawStep};
+        if (gridded) {
+            if (drawStep > 0) {
+                gridStep = drawStep;
+                gridView = left_bottom_right_top;
+                gridPrecision = precision;
+                gridCardioidCheck = cardioidCheck;
+                gridColorPeriods = colorPeriods;
+                gridMaxIt = maxIt;
+                gridWidth = renderWidth;
+                gridHeight = renderHeight;
+            }
+            gridFor(gridStep).BlitToScreen(framebufferWidth, framebufferHeight);
+        } else if (dynamicResolution) {
+            offscreen.BlitToScreen(framebufferWidth, framebufferHeight);
+        }
+        reprojectable = reprojection && !progressive && precision >= mandelbrot::Precision::kPerturbation;
+
+        if (drawStep > 0)
+            stateValid = stateful && drawStep == 1;
+        if (stateful && drawStep == 1) {
+            // The next frame reads what this one wrote
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+            stateView = left_bottom_right_top;
+            statePrecision = precision;
+            stateCardioidCheck = cardioidCheck;
+            stateMaxIt = maxIt;
+        }
 
         /***************
         * UPDATE LOGIC *
         ***************/
-        // Update the projection matrix
-        frameLatency = 1.0f / 144.0f;
-        left_bottom = destination + (left_bottom - destination) / ((zoom - 1.0f) * frameLatency + 1.0f);
-        right_top = destination + (right_top - destination) / ((zoom - 1.0f) * frameLatency + 1.0f);
-        totalZoom *= ((zoom - 1.0f) * frameLatency + 1.0f);
-        left_bottom_right_top = glm::dvec4(left_bottom, right_top);
-        maxIt = maxIt + 20 * frameLatency;
+        // Update the projection matrix by the time the frame took, though a
+        // stalled one (a long reference orbit, a resize) moves the view no
+        // further than a tenth of a second would
+        double zoomStep = std::pow(zoom, std::min(frameLatency, 0.1));
+        if (!paused) {
+            left_bottom_offset = left_bottom_offset / zoomStep;
+            right_top_offset = right_top_offset / zoomStep;
+            if (right_top_offset.y - left_bottom_offset.y < 0x1p-512) {
+                // Exact, and only reached long past double-double, whose shader
+                // reads the offsets unscaled
+                left_bottom_offset = left_bottom_offset * 0x1p512;
+                right_top_offset = right_top_offset * 0x1p512;
+                offsetExponent -= 512;
+            }
+            double offsetScale = std::ldexp(1.0, static_cast<int>(std::max<int64_t>(offsetExponent, -1100)));
+            left_bottom = destination + left_bottom_offset * offsetScale;
+            right_top = destination + right_top_offset * offsetScale;
+            totalZoom = totalZoom * mandelbrot::FloatExp(zoomStep);
+            left_bottom_right_top = glm::dvec4(left_bottom, right_top);
+        }
+        if (!adaptiveIterations) {
+            maxIt = maxIt + 20 * frameLatency;
+        } else if (escapesReady) {
+            escapesReady = false;
+            iterationDecision = iterationController.Plan(escapes, escapesMaxIt, escapesSeconds);
+            maxIt = iterationDecision.max_it;
+            // Log once it moved by a histogram bin or the budget took over
+            if (std::abs(std::log2(maxIt / loggedMaxIt)) >= 1.0 / mandelbrot::kHistogramBinsPerOctave || iterationDecision.capped != loggedCapped) {
+                std::cout << "Max iterations: " << static_cast<int>(loggedMaxIt) << " -> " << static_cast<int>(maxIt) << ", " << iterationDecision.unresolved * 100 << "% of escaping pixels unresolved at " << static_cast<int>(escapesMaxIt) << " in " << escapesSeconds * 1000 << " ms" << (iterationDecision.capped ? ", capped by frame time" : "") << std::endl;
+                loggedMaxIt = maxIt;
+                loggedCapped = iterationDecision.capped;
+            }
+        }
 
         /****************
         * UPDATE SCREEN *
@@ -0,0 +1,140 @@
+#version 460 core
+
+in vec2 fragmentCoords;
+
+out vec4 color;
+
+// Point zoomed into as double-double (re.hi, im.hi, re.lo, im.lo), and the
+// Left-Bottom and Right-Top corners as offsets from it
+uniform dvec4 center;
+uniform dvec4 lbrt;
+uniform float colorPeriod;
+uniform float maxIt;
+uniform bool cardioidCheck;
+
+uniform sampler1D colormap;
+
+#include "histogram.glsl"
+#include "periodicity.glsl"
+
+// Double-double numbers are (hi, lo) with hi + lo the value. The error-free
+// transforms below only hold as written, so every result is precise.
+
+// s + e = a + b exactly
+dvec2 TwoSum(double a, double b)
+{
+	precise double s  = a + b;
+	precise double bb = s - a;
+	precise double e  = (a - (s - bb)) + (b - bb);
+	return dvec2(s, e);
+}
+
+// TwoSum for |a| >= |b|
+dvec2 QuickTwoSum(double a, double b)
+{
+	precise double s = a + b;
+	precise double e = b - (s - a);
+	return dvec2(s, e);
+}
+
+// p + e = a b exactly
+dvec2 TwoProduct(double a, double b)
+{
+	precise double p = a * b;
+	precise double e = fma(a, b, -p);
+	return dvec2(p, e);
+}
+
+dvec2 Add(dvec2 a, dvec2 b)
+{
+	precise dvec2 s = TwoSum(a.x, b.x);
+	precise dvec2 t = TwoSum(a.y, b.y);
+	s.y += t.x;
+	s = QuickTwoSum(s.x, s.y);
+	s.y += t.y;
+	return QuickTwoSum(s.x, s.y);
+}
+
+dvec2 Multiply(dvec2 a, dvec2 b)
+{
+	precise dvec2 p = TwoProduct(a.x, b.x);
+	p.y += a.x * b.y + a.y * b.x;
+	return QuickTwoSum(p.x, p.y);
+}
+
+// Period of the main cardioid (1) or the period-2 bulb (2) if c lies in one,
+// whose points never escape, and 0 otherwise
+uint CardioidOrBulbPeriod(dvec2 c)
+{
+	double x  = c.x - 0.25;
+	double y2 = c.y * c.y;
+	double q  = x * x + y2;
+	if (q * (q + x) <= 0.25 * y2)
+		return 1u;
+	if ((c.x + 1) * (c.x + 1) + y2 <= 0.0625)
+		return 2u;
+	return 0u;
+}
+
+void main()
+{
+	dvec2 lb = lbrt.xy, rt = lbrt.zw;
+	dvec2 offset = lb + (rt - lb) * dvec2(fragmentCoords);
+	dvec2 cx = Add(dvec2(center.x, center.z), dvec2(offset.x, 0));
+	dvec2 cy = Add(dvec2(center.y, center.w), dvec2(offset.y, 0));
+
+	uint period = cardioidCheck ? CardioidOrBulbPeriod(dvec2(cx.x, cy.x)) : 0u;
+	if (period != 0u)
+	{
+		CountEscape(0.0f, false);
+		color = InteriorColor(period);
+		return;
+	}
+
+	dvec2 zx  = dvec2(0, 0), zy  = dvec2(0, 0);
+	dvec2 zx2 = dvec2(0, 0), zy2 = dvec2(0, 0);
+
+	// Brent's cycle detection as in EscapeTimeBrent(), on the high parts of
+	// the distance to the saved z
+	double tolerance2 = double(periodicityTolerance) * double(periodicityTolerance);
+	dvec2 sx = dvec2(0, 0), sy = dvec2(0, 0);
+	float saved  = 0.0f;
+	float saveAt = 1.0f;
+
+	float it = 0.0f;
+	for (; it < maxIt && zx2.x + zy2.x <= (1 << 16); it++) {
+		dvec2 zxy = Multiply(zx, zy);
+		zy  = Add(Add(zxy, zxy), cy);
+		zx  = Add(Add(zx2, -zy2), cx);
+		zx2 = Multiply(zx, zx);
+		zy2 = Multiply(zy, zy);
+
+		double dx = Add(zx, -sx).x, dy = Add(zy, -sy).x;
+		if (tolerance2 > 0 && dx * dx + dy * dy <= tolerance2)
+		{
+			period = uint(it + 1 - saved);
+			break;
+		}
+		if (it + 1 == saveAt)
+		{
+			sx     = zx;
+			sy     = zy;
+			saved  = it + 1;
+			saveAt = 2 * saveAt;
+		}
+	}
+
+	if (period != 0u || it >= maxIt)
+	{
+		CountEscape(it, false);
+		color = InteriorColor(period);
+	}
+	else
+	{
+		CountEscape(it, true);
+		float log_zn = log(float(zx2.x + zy2.x)) / 2;
+		float nu = log(log_zn / log(2)) / log(2);
+		it = it + 1 - nu;
+		color = texture(colormap, it / colorPeriod);
+	}
+}
@@ -0,0 +1,123 @@
+#version 460 core
+
+in vec2 fragmentCoords;
+
+out vec4 color;
+
+uniform vec4 lbrt;
+uniform float colorPeriod;
+uniform float maxIt;
+uniform bool cardioidCheck;
+
+uniform sampler1D colormap;
+
+#include "histogram.glsl"
+#include "periodicity.glsl"
+
+// mandelbrot.frag in plain float, the cheapest kernel on any GPU while the
+// view is shallow enough for 24 bits
+
+// The per-pixel progress of mandelbrot.frag, whose dvec2 holds a vec2 exactly
+struct PixelState
+{
+	dvec2 z;
+	float it;
+	uint  done;
+	// Period of the cycle an interior pixel settled into, 0 if none was
+	// detected
+	uint  period;
+};
+
+layout(std430, binding = 0) buffer State
+{
+	PixelState pixels[];
+};
+
+uniform bool resume;
+uniform int  stateWidth;
+
+const uint kIterating = 0u;
+const uint kEscaped   = 1u;
+const uint kInterior  = 2u;
+
+// Period of the main cardioid (1) or the period-2 bulb (2) if c lies in one,
+// whose points never escape, and 0 otherwise
+uint CardioidOrBulbPeriod(vec2 c)
+{
+	float x  = c.x - 0.25;
+	float y2 = c.y * c.y;
+	float q  = x * x + y2;
+	if (q * (q + x) <= 0.25 * y2)
+		return 1u;
+	if ((c.x + 1) * (c.x + 1) + y2 <= 0.0625)
+		return 2u;
+	return 0u;
+}
+
+void main()
+{
+	vec2 lb = lbrt.xy, rt = lbrt.zw;
+	vec2 c  = lb + (rt - lb) * fragmentCoords;
+
+	uint index = uint(gl_FragCoord.y) * uint(stateWidth) + uint(gl_FragCoord.x);
+	PixelState state = PixelState(dvec2(0, 0), 0.0f, kIterating, 0u);
+	if (resume)
+		state = pixels[index];
+	else if (cardioidCheck)
+		state.period = CardioidOrBulbPeriod(c);
+	if (!resume && state.period != 0u)
+		state.done = kInterior;
+
+	vec2 z  = vec2(state.z);
+	vec2 z2 = z * z;
+
+	float it = state.it;
+	if (state.done == kIterating)
+	{
+		// Brent's cycle detection as in EscapeTimeBrent(): z is compared with
+		// a copy saved at every power-of-two iteration. A resumed pixel
+		// starts the schedule over from where it stopped.
+		float tolerance2 = periodicityTolerance * periodicityTolerance;
+		vec2  s      = z;
+		float saved  = it;
+		float saveAt = max(1.0f, 2.0f * it);
+		for (; it < maxIt && z2.x + z2.y <= (1 << 16); it++) {
+			z  = vec2(z2.x - z2.y + c.x, 2 * z.x * z.y + c.y);
+			z2 = vec2(z.x * z.x, z.y * z.y);
+
+			vec2 d = z - s;
+			if (tolerance2 > 0 && dot(d, d) <= tolerance2)
+			{
+				state.period = uint(it + 1 - saved);
+				break;
+			}
+			if (it + 1 == saveAt)
+			{
+				s      = z;
+				saved  = it + 1;
+				saveAt = 2 * saveAt;
+			}
+		}
+		uint done = state.period != 0u ? kInterior : z2.x + z2.y > (1 << 16) ? kEscaped : kIterating;
+		state = PixelState(dvec2(z), it, done, state.period);
+		pixels[index] = state;
+	}
+	else if (!resume)
+	{
+		pixels[index] = state;
+	}
+
+	if (state.done != kEscaped || it >= maxIt)
+	{
+		CountEscape(it, false);
+		color = InteriorColor(state.period);
+	}
+	else
+	{
+		CountEscape(it, true);
+		float log_zn = log(z2.x + z2.y) / 2;
+		float nu = log(log_zn / log(2)) / log(2);
+		it = it + 1 - nu;
+		color = texture(colormap, it / colorPeriod);
+	}
+}
@@ -0,0 +1,140 @@
+#version 460 core
+
+in vec2 fragmentCoords;
+
+out vec4 color;
+
+// Left-Bottom corner as float-float (x.hi, x.lo, y.hi, y.lo) and the size of
+// the view, which only needs float precision of its own
+uniform vec4 leftBottom;
+uniform vec2 size;
+uniform float colorPeriod;
+uniform float maxIt;
+uniform bool cardioidCheck;
+
+uniform sampler1D colormap;
+
+#include "histogram.glsl"
+#include "periodicity.glsl"
+
+// mandelbrot.frag without doubles, for GPUs whose fp64 is many times slower
+// than fp32. Float-float numbers are (hi, lo) with hi + lo the value, about
+// 48 bits in all. The error-free transforms below only hold as written, so
+// every result is precise.
+
+// s + e = a + b exactly
+vec2 TwoSum(float a, float b)
+{
+	precise float s  = a + b;
+	precise float bb = s - a;
+	precise float e  = (a - (s - bb)) + (b - bb);
+	return vec2(s, e);
+}
+
+// TwoSum for |a| >= |b|
+vec2 QuickTwoSum(float a, float b)
+{
+	precise float s = a + b;
+	precise float e = b - (s - a);
+	return vec2(s, e);
+}
+
+// p + e = a b exactly
+vec2 TwoProduct(float a, float b)
+{
+	precise float p = a * b;
+	precise float e = fma(a, b, -p);
+	return vec2(p, e);
+}
+
+vec2 Add(vec2 a, vec2 b)
+{
+	precise vec2 s = TwoSum(a.x, b.x);
+	precise vec2 t = TwoSum(a.y, b.y);
+	s.y += t.x;
+	s = QuickTwoSum(s.x, s.y);
+	s.y += t.y;
+	return QuickTwoSum(s.x, s.y);
+}
+
+vec2 Multiply(vec2 a, vec2 b)
+{
+	precise vec2 p = TwoProduct(a.x, b.x);
+	p.y += a.x * b.y + a.y * b.x;
+	return QuickTwoSum(p.x, p.y);
+}
+
+// Period of the main cardioid (1) or the period-2 bulb (2) if c lies in one,
+// whose points never escape, and 0 otherwise
+uint CardioidOrBulbPeriod(vec2 c)
+{
+	float x  = c.x - 0.25;
+	float y2 = c.y * c.y;
+	float q  = x * x + y2;
+	if (q * (q + x) <= 0.25 * y2)
+		return 1u;
+	if ((c.x + 1) * (c.x + 1) + y2 <= 0.0625)
+		return 2u;
+	return 0u;
+}
+
+void main()
+{
+	vec2 cx = Add(leftBottom.xy, TwoProduct(size.x, fragmentCoords.x));
+	vec2 cy = Add(leftBottom.zw, TwoProduct(size.y, fragmentCoords.y));
+
+	uint period = cardioidCheck ? CardioidOrBulbPeriod(vec2(cx.x, cy.x)) : 0u;
+	if (period != 0u)
+	{
+		CountEscape(0.0f, false);
+		color = InteriorColor(period);
+		return;
+	}
+
+	vec2 zx  = vec2(0, 0), zy  = vec2(0, 0);
+	vec2 zx2 = vec2(0, 0), zy2 = vec2(0, 0);
+
+	// Brent's cycle detection as in EscapeTimeBrent(), on the high parts of
+	// the distance to the saved z
+	float tolerance2 = periodicityTolerance * periodicityTolerance;
+	vec2 sx = vec2(0, 0), sy = vec2(0, 0);
+	float saved  = 0.0f;
+	float saveAt = 1.0f;
+
+	float it = 0.0f;
+	for (; it < maxIt && zx2.x + zy2.x <= (1 << 16); it++) {
+		vec2 zxy = Multiply(zx, zy);
+		zy  = Add(Add(zxy, zxy), cy);
+		zx  = Add(Add(zx2, -zy2), cx);
+		zx2 = Multiply(zx, zx);
+		zy2 = Multiply(zy, zy);
+
+		float dx = Add(zx, -sx).x, dy = Add(zy, -sy).x;
+		if (tolerance2 > 0 && dx * dx + dy * dy <= tolerance2)
+		{
+			period = uint(it + 1 - saved);
+			break;
+		}
+		if (it + 1 == saveAt)
+		{
+			sx     = zx;
+			sy     = zy;
+			saved  = it + 1;
+			saveAt = 2 * saveAt;
+		}
+	}
+
+	if (period != 0u || it >= maxIt)
+	{
+		CountEscape(it, false);
+		color = InteriorColor(period);
+	}
+	else
+	{
+		CountEscape(it, true);
+		float log_zn = log(zx2.x + zy2.x) / 2;
+		float nu = log(log_zn / log(2)) / log(2);
+		it = it + 1 - nu;
+		color = texture(colormap, it / colorPeriod);
+	}
+}
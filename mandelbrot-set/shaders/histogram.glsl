@@ -0,0 +1,21 @@
+// Escape counts of the frame, kBinsPerOctave bins per octave of iterations
+// and the last bin for pixels that did not escape, read back to pick maxIt
+// (see mandelbrot-core/iteration_control.h). #included by the escape-time
+// shaders, which opengl::Shader expands.
+layout(std430, binding = 1) buffer Histogram
+{
+	uint bins[];
+};
+
+uniform bool countEscapes;
+
+const float kBinsPerOctave = 8.0f;
+const int   kBins          = 256;
+
+void CountEscape(float it, bool escaped)
+{
+	if (!countEscapes)
+		return;
+	int bin = escaped ? min(int(log2(max(it, 1.0f)) * kBinsPerOctave), kBins - 2) : kBins - 1;
+	atomicAdd(bins[bin], 1u);
+}
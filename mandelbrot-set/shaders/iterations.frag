@@ -0,0 +1,23 @@
+#version 460 core
+
+out vec4 color;
+
+uniform float colorPeriod;
+
+uniform sampler1D colormap;
+uniform sampler2D iterations;
+
+// Colors smoothed iteration counts rendered on the CPU, one texel per pixel
+void main()
+{
+	float it = texelFetch(iterations, ivec2(gl_FragCoord.xy), 0).r;
+
+	if (isinf(it))
+	{
+		color = vec4(0.0f);
+	}
+	else
+	{
+		color = texture(colormap, it / colorPeriod);
+	}
+}
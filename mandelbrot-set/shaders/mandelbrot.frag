@@ -7,28 +7,113 @@ out vec4 color;
 uniform dvec4 lbrt;
 uniform float colorPeriod;
 uniform float maxIt;
+uniform bool cardioidCheck;
 
 uniform sampler1D colormap;
 
+#include "histogram.glsl"
+#include "periodicity.glsl"
+
+// Progress of every pixel, kept across frames of the same view so that a
+// rising maxIt only iterates on the pixels that had not escaped yet
+struct PixelState
+{
+	dvec2 z;
+	float it;
+	uint  done;
+	// Period of the cycle an interior pixel settled into, 0 if none was
+	// detected
+	uint  period;
+};
+
+layout(std430, binding = 0) buffer State
+{
+	PixelState pixels[];
+};
+
+// Whether pixels[] holds the last frame of this view, and its row pitch
+uniform bool resume;
+uniform int  stateWidth;
+
+const uint kIterating = 0u;
+const uint kEscaped   = 1u;
+const uint kInterior  = 2u;
+
+// Period of the main cardioid (1) or the period-2 bulb (2) if c lies in one,
+// whose points never escape, and 0 otherwise
+uint CardioidOrBulbPeriod(dvec2 c)
+{
+	double x  = c.x - 0.25;
+	double y2 = c.y * c.y;
+	double q  = x * x + y2;
+	if (q * (q + x) <= 0.25 * y2)
+		return 1u;
+	if ((c.x + 1) * (c.x + 1) + y2 <= 0.0625)
+		return 2u;
+	return 0u;
+}
+
 void main()
 {
 	dvec2 lb = lbrt.xy, rt = lbrt.zw;
 	dvec2 c  = lb + (rt - lb) * dvec2(fragmentCoords);
-	dvec2 z  = dvec2(0, 0);
-	dvec2 z2 = dvec2(0, 0);
 
-	float it = 0.0f;
-	for (; it < maxIt && z2.x + z2.y <= (1 << 16); it++) {
-		z  = dvec2(z2.x - z2.y + c.x, 2 * z.x * z.y + c.y);
-		z2 = dvec2(z.x * z.x, z.y * z.y);
+	uint index = uint(gl_FragCoord.y) * uint(stateWidth) + uint(gl_FragCoord.x);
+	PixelState state = PixelState(dvec2(0, 0), 0.0f, kIterating, 0u);
+	if (resume)
+		state = pixels[index];
+	else if (cardioidCheck)
+		state.period = CardioidOrBulbPeriod(c);
+	if (!resume && state.period != 0u)
+		state.done = kInterior;
+
+	dvec2 z  = state.z;
+	dvec2 z2 = z * z;
+
+	float it = state.it;
+	if (state.done == kIterating)
+	{
+		// Brent's cycle detection as in EscapeTimeBrent(): z is compared with
+		// a copy saved at every power-of-two iteration. A resumed pixel
+		// starts the schedule over from where it stopped.
+		double tolerance2 = double(periodicityTolerance) * double(periodicityTolerance);
+		dvec2 s      = z;
+		float saved  = it;
+		float saveAt = max(1.0f, 2.0f * it);
+		for (; it < maxIt && z2.x + z2.y <= (1 << 16); it++) {
+			z  = dvec2(z2.x - z2.y + c.x, 2 * z.x * z.y + c.y);
+			z2 = dvec2(z.x * z.x, z.y * z.y);
+
+			dvec2 d = z - s;
+			if (tolerance2 > 0 && dot(d, d) <= tolerance2)
+			{
+				state.period = uint(it + 1 - saved);
+				break;
+			}
+			if (it + 1 == saveAt)
+			{
+				s      = z;
+				saved  = it + 1;
+				saveAt = 2 * saveAt;
+			}
+		}
+		uint done = state.period != 0u ? kInterior : z2.x + z2.y > (1 << 16) ? kEscaped : kIterating;
+		state = PixelState(z, it, done, state.period);
+		pixels[index] = state;
+	}
+	else if (!resume)
+	{
+		pixels[index] = state;
 	}
 
-	if (it >= maxIt)
+	if (state.done != kEscaped || it >= maxIt)
 	{
-		color = vec4(0.0f);
+		CountEscape(it, false);
+		color = InteriorColor(state.period);
 	}
 	else
 	{
+		CountEscape(it, true);
 		float log_zn = log(float(z2.x + z2.y)) / 2;
 		float nu = log(log_zn / log(2)) / log(2);
 		it = it + 1 - nu;
@@ -0,0 +1,15 @@
+// Brent's cycle detection radius, RenderParams::periodicity_tolerance times
+// the pixel spacing with 0 disabling it, and whether interior
+// pixels are colored by the period of the cycle they settled into.
+// #included by the escape-time shaders, which opengl::Shader expands.
+uniform float periodicityTolerance;
+uniform bool  colorPeriods;
+
+// Black, or with colorPeriods a darkened texel of the colormap per period
+// (modulo its four texels) where one was detected
+vec4 InteriorColor(uint period)
+{
+	if (!colorPeriods || period == 0u)
+		return vec4(0.0f);
+	return vec4(0.5f * texture(colormap, (float(period) - 0.5f) / 4.0f).rgb, 1.0f);
+}
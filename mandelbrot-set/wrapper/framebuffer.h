@@ -0,0 +1,41 @@
+#ifndef MANDELBROT_SET_WRAPPER_FRAMEBUFFER_H_
+#define MANDELBROT_SET_WRAPPER_FRAMEBUFFER_H_
+
+#include <glad/gl.h>
+
+namespace opengl {
+
+// Offscreen color and depth target of an adjustable size, drawn into instead
+// of the window and stretched over it afterwards
+class Framebuffer {
+ public:
+  Framebuffer();
+  ~Framebuffer();
+
+  Framebuffer(const Framebuffer &) = delete;
+  Framebuffer &operator=(const Framebuffer &) = delete;
+
+  // Reallocates the attachments if the size changed
+  void Resize(int width, int height);
+
+  // Draws into the target from now on, over all of it
+  void Bind();
+
+  // Stretches the target over the default framebuffer of `width` x
+  // `height`, filtered linearly, and draws into that from now on
+  void BlitToScreen(int width, int height);
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+
+ private:
+  GLuint framebuffer_;
+  GLuint color_;
+  GLuint depth_;
+  int width_ = 0;
+  int height_ = 0;
+};
+
+};  // namespace opengl
+
+#endif  // MANDELBROT_SET_WRAPPER_FRAMEBUFFER_H_
@@ -0,0 +1,62 @@
+#include "mandelbrot-set/wrapper/histogram.h"
+
+namespace opengl {
+
+HistogramBuffer::HistogramBuffer(int bins, GLuint binding) : bins_(bins), binding_(binding) {
+  glGenBuffers(kSpans, buffers_);
+  for (GLuint buffer : buffers_) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * bins, nullptr, GL_DYNAMIC_READ);
+  }
+  // Always bound, so shaders told to count have somewhere to
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_, buffers_[0]);
+}
+
+HistogramBuffer::~HistogramBuffer() {
+  for (GLsync fence : fences_) {
+    if (fence)
+      glDeleteSync(fence);
+  }
+  glDeleteBuffers(kSpans, buffers_);
+}
+
+long HistogramBuffer::Begin() {
+  // The GPU is a whole ring behind: give up on the oldest span
+  if (next_ - unread_ == kSpans)
+    unread_++;
+  int slot = next_ % kSpans;
+  if (fences_[slot]) {
+    glDeleteSync(fences_[slot]);
+    fences_[slot] = nullptr;
+  }
+  GLuint zero = 0;
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_, buffers_[slot]);
+  glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+  return next_;
+}
+
+void HistogramBuffer::End() {
+  // The counts are read through glGetBufferSubData, after the draws
+  glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+  fences_[next_ % kSpans] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  next_++;
+}
+
+bool HistogramBuffer::Read(std::vector<uint32_t> &bins, long &span) {
+  if (unread_ == next_)
+    return false;
+  int slot = unread_ % kSpans;
+  GLenum status = glClientWaitSync(fences_[slot], 0, 0);
+  if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+    return false;
+  glDeleteSync(fences_[slot]);
+  fences_[slot] = nullptr;
+  bins.resize(bins_);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers_[slot]);
+  glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint) * bins_, bins.data());
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  span = unread_++;
+  return true;
+}
+
+};  // namespace opengl
@@ -0,0 +1,48 @@
+#ifndef MANDELBROT_SET_WRAPPER_HISTOGRAM_H_
+#define MANDELBROT_SET_WRAPPER_HISTOGRAM_H_
+
+#include <glad/gl.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace opengl {
+
+// Shader storage the shaders count escapes into between Begin() and End(),
+// read back frames later so the CPU never waits for it
+class HistogramBuffer {
+ public:
+  // Spans that can be in flight at once; a span still unread when its
+  // buffer comes round again is dropped
+  static constexpr int kSpans = 4;
+
+  // `bins` counters, bound to shader storage binding `binding`
+  HistogramBuffer(int bins, GLuint binding);
+  ~HistogramBuffer();
+
+  HistogramBuffer(const HistogramBuffer &) = delete;
+  HistogramBuffer &operator=(const HistogramBuffer &) = delete;
+
+  // Zeroes a buffer and binds it for the draws that follow; the number of
+  // the span, from 0 on
+  long Begin();
+  void End();
+
+  // Counts of the oldest unread span if the GPU is done with them, and its
+  // number. Spans are read in the order they were recorded, each once.
+  bool Read(std::vector<uint32_t> &bins, long &span);
+
+ private:
+  // Spans go round the buffers, so older ones can be read while a new one
+  // is counted into
+  GLuint buffers_[kSpans];
+  GLsync fences_[kSpans] = {};
+  long next_ = 0;
+  long unread_ = 0;
+  int bins_;
+  GLuint binding_;
+};
+
+};  // namespace opengl
+
+#endif  // MANDELBROT_SET_WRAPPER_HISTOGRAM_H_
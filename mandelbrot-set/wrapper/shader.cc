@@ -10,6 +10,32 @@
 
 namespace opengl {
 
+namespace {
+
+// Replaces every `#include "file"` line of `code` by the source of `file`,
+// relative to `directory`, as GLSL has none of its own. #line directives
+// keep the line numbers of compile errors those of `code`.
+std::string ExpandIncludes(const std::string &code, const std::filesystem::path &directory) {
+  std::istringstream lines(code);
+  std::stringstream expanded;
+  std::string line;
+  for (int number = 1; std::getline(lines, line); number++) {
+    const std::string directive = "#include \"";
+    if (line.rfind(directive, 0) != 0) {
+      expanded << line << '\n';
+      continue;
+    }
+    std::ifstream include_fstream;
+    include_fstream.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    include_fstream.open(directory / line.substr(directive.size(), line.find('"', directive.size()) - directive.size()));
+    expanded << include_fstream.rdbuf() << '\n';
+    expanded << "#line " << number + 1 << '\n';
+  }
+  return expanded.str();
+}
+
+};  // namespace
+
 Shader::Shader(const std::filesystem::path &vertexPath, const std::filesystem::path &fragmentPath) {
   // 1. Retrieve the vertex/fragment source code from filePath
   std::string vertex_code, fragment_code;
@@ -30,7 +56,7 @@ Shader::Shader(const std::filesystem::path &vertexPath, const std::filesystem::p
     fragment_fstream.close();
 
     vertex_code = vertex_sstream.str();
-    fragment_code = fragment_sstream.str();
+    fragment_code = ExpandIncludes(fragment_sstream.str(), fragmentPath.parent_path());
   } catch (const std::ifstream::failure &ex) {
     std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
     return;
@@ -114,12 +140,30 @@ void Shader::SetUniform<glm::dvec4>(const std::string &name, const glm::dvec4 &v
   glUniform4dv(location, 1, &value[0]);
 };
 
+template <>
+void Shader::SetUniform<glm::vec4>(const std::string &name, const glm::vec4 &value) const {
+  GLuint location = glGetUniformLocation(id_, name.c_str());
+  glUniform4fv(location, 1, &value[0]);
+};
+
+template <>
+void Shader::SetUniform<glm::vec2>(const std::string &name, const glm::vec2 &value) const {
+  GLuint location = glGetUniformLocation(id_, name.c_str());
+  glUniform2fv(location, 1, &value[0]);
+};
+
 template <>
 void Shader::SetUniform<float>(const std::string &name, const float &value) const {
   GLuint location = glGetUniformLocation(id_, name.c_str());
   glUniform1f(location, value);
 };
 
+template <>
+void Shader::SetUniform<bool>(const std::string &name, const bool &value) const {
+  GLuint location = glGetUniformLocation(id_, name.c_str());
+  glUniform1i(location, value);
+};
+
 template <>
 void Shader::SetUniform<int>(const std::string &name, const int &value) const {
   GLuint location = glGetUniformLocation(id_, name.c_str());
@@ -0,0 +1,41 @@
+#include "mandelbrot-set/wrapper/timer.h"
+
+namespace opengl {
+
+GpuTimer::GpuTimer() {
+  glGenQueries(kSpans, queries_);
+}
+
+GpuTimer::~GpuTimer() {
+  glDeleteQueries(kSpans, queries_);
+}
+
+long GpuTimer::Begin() {
+  // The GPU is a whole ring behind: give up on the oldest span
+  if (next_ - unread_ == kSpans)
+    unread_++;
+  glBeginQuery(GL_TIME_ELAPSED, queries_[next_ % kSpans]);
+  return next_;
+}
+
+void GpuTimer::End() {
+  glEndQuery(GL_TIME_ELAPSED);
+  next_++;
+}
+
+bool GpuTimer::Read(double &seconds, long &span) {
+  if (unread_ == next_)
+    return false;
+  GLuint query = queries_[unread_ % kSpans];
+  GLint available = 0;
+  glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available)
+    return false;
+  GLuint64 nanoseconds = 0;
+  glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+  seconds = nanoseconds / 1e9;
+  span = unread_++;
+  return true;
+}
+
+};  // namespace opengl
@@ -0,0 +1,40 @@
+#ifndef MANDELBROT_SET_WRAPPER_TIMER_H_
+#define MANDELBROT_SET_WRAPPER_TIMER_H_
+
+#include <glad/gl.h>
+
+namespace opengl {
+
+// GPU time taken by the commands between Begin() and End(), read back
+// frames later so the CPU never waits for it
+class GpuTimer {
+ public:
+  // Spans that can be in flight at once; a span still unread when its
+  // query comes round again is dropped
+  static constexpr int kSpans = 4;
+
+  GpuTimer();
+  ~GpuTimer();
+
+  GpuTimer(const GpuTimer &) = delete;
+  GpuTimer &operator=(const GpuTimer &) = delete;
+
+  // Starts a span, numbered from 0 on, and returns its number
+  long Begin();
+  void End();
+
+  // Seconds taken by the oldest unread span if the GPU is done with it, and
+  // its number. Spans are read in the order they were recorded, each once.
+  bool Read(double &seconds, long &span);
+
+ private:
+  // Spans go round the queries, so older ones can be read while a new one
+  // is recorded
+  GLuint queries_[kSpans];
+  long next_ = 0;
+  long unread_ = 0;
+};
+
+};  // namespace opengl
+
+#endif  // MANDELBROT_SET_WRAPPER_TIMER_H_
@@ -0,0 +1,211 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <numbers>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mandelbrot-core/exponential_map.h"
+#include "mandelbrot-core/fixed_point.h"
+#include "mandelbrot-core/float_exp.h"
+#include "mandelbrot-core/keyframes.h"
+#include "mandelbrot-core/renderer.h"
+#include "mandelbrot-core/scheduler.h"
+
+// Half-height of the first frame, the (-2, -2) (2, 2) view of mandelbrot-set
+constexpr double kStartRadius = 2.0;
+
+// The colormap of mandelbrot-set, sampled like its GL_REPEAT, GL_LINEAR
+// 1D texture
+constexpr unsigned char kColormap[4][3] = {
+    {0, 139, 224},
+    {215, 215, 215},
+    {223, 113, 0},
+    {60, 0, 57},
+};
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 2^exponent as a FloatExp, for any depth
+mandelbrot::FloatExp Pow2(double exponent) {
+  double whole = std::floor(exponent);
+  return mandelbrot::FloatExp(std::exp2(exponent - whole), static_cast<int64_t>(whole));
+}
+
+// Writes `frame` as a binary PPM, colored like iterations.frag
+bool WriteFrame(const std::string &path, const mandelbrot::IterationBuffer &frame, float color_period) {
+  std::ofstream out(path, std::ios::binary);
+  out << "P6\n" << frame.width << " " << frame.height << "\n255\n";
+  std::vector<unsigned char> row(static_cast<size_t>(frame.width) * 3);
+  // PPM rows run top to bottom
+  for (int y = frame.height - 1; y >= 0; y--) {
+    for (int x = 0; x < frame.width; x++) {
+      float it = frame.At(x, y);
+      unsigned char *pixel = &row[static_cast<size_t>(x) * 3];
+      if (std::isinf(it)) {
+        pixel[0] = pixel[1] = pixel[2] = 0;
+        continue;
+      }
+      double texel = it / color_period * 4 - 0.5;
+      double floor = std::floor(texel);
+      int first = static_cast<int>(static_cast<int64_t>(floor) & 3), second = (first + 1) & 3;
+      double t = texel - floor;
+      for (int channel = 0; channel < 3; channel++)
+        pixel[channel] = static_cast<unsigned char>(std::lround(kColormap[first][channel] * (1 - t) + kColormap[second][channel] * t));
+    }
+    out.write(reinterpret_cast<const char *>(row.data()), static_cast<std::streamsize>(row.size()));
+  }
+  return static_cast<bool>(out);
+}
+
+// The strip of the zoom, loaded from `path` unless it has to be rendered
+std::optional<mandelbrot::ExponentialMap> ExponentialMap(const std::string &path, const mandelbrot::FixedComplex &destination, const mandelbrot::FloatExp &start_radius, const mandelbrot::FloatExp &end_radius, int width, int height, float max_it) {
+  // The strip runs from the corners of the first frame to a pixel of the last
+  mandelbrot::FloatExp outer_radius = start_radius * mandelbrot::FloatExp(std::hypot(static_cast<double>(width) / height, 1.0));
+  mandelbrot::FloatExp inner_radius = end_radius / mandelbrot::FloatExp(height);
+  int samples = static_cast<int>(std::ceil(std::numbers::pi * std::hypot(width, height)));
+  std::optional<mandelbrot::ExponentialMap> map = mandelbrot::ExponentialMap::Load(path);
+  if (map && (map->center() != destination || map->width() != samples || map->outer_radius() < outer_radius || outer_radius < map->outer_radius() || map->Radius(map->height() - 1) > inner_radius * mandelbrot::FloatExp(1.01) || map->max_it() != max_it)) {
+    std::cout << path << " has another center, size or max iterations, or stops short of the depth, rendering it again" << std::endl;
+    map.reset();
+  }
+  if (map) {
+    std::cout << "Loaded " << path << ": " << map->width() << "x" << map->height() << " samples" << std::endl;
+    return map;
+  }
+
+  mandelbrot::ExponentialMapParams params{destination, outer_radius, inner_radius, samples, max_it};
+  mandelbrot::TileScheduler scheduler;
+  map.emplace();
+  mandelbrot::ExponentialMapStats stats = map->Render(params, scheduler);
+  std::cout << "Rendered " << map->width() << "x" << map->height() << " samples in " << stats.bands << " bands: reference "
+            << stats.reference_seconds << " s, BLA " << stats.bla_seconds << " s, samples " << stats.render_seconds << " s" << std::endl;
+  if (!map->Save(path))
+    std::cout << "Failed to write " << path << std::endl;
+  return map;
+}
+
+// The keyframes of the zoom, loaded from `path` unless they have to be
+// rendered
+std::optional<mandelbrot::KeyframeSequence> Keyframes(const std::string &path, const mandelbrot::FixedComplex &destination, const mandelbrot::FloatExp &start_radius, double octaves, int width, int height, float max_it) {
+  // One keyframe per halving, the last at or past the end of the zoom
+  int keyframes = static_cast<int>(std::ceil(octaves)) + 1;
+  std::optional<mandelbrot::KeyframeSequence> sequence = mandelbrot::KeyframeSequence::Load(path);
+  if (sequence && (sequence->center() != destination || sequence->keyframes() < keyframes || sequence->width() != width || sequence->height() != height || sequence->max_it() != max_it || sequence->start_radius() < start_radius || start_radius < sequence->start_radius())) {
+    std::cout << path << " has another center, size or max iterations, or stops short of the depth, rendering it again" << std::endl;
+    sequence.reset();
+  }
+  if (sequence) {
+    std::cout << "Loaded " << path << ": " << sequence->keyframes() << " keyframes" << std::endl;
+    return sequence;
+  }
+
+  mandelbrot::TileScheduler scheduler;
+  sequence.emplace();
+  mandelbrot::KeyframeStats stats = sequence->Render({destination, start_radius, keyframes, width, height, max_it}, scheduler);
+  std::cout << "Rendered " << keyframes << " keyframes of " << width * mandelbrot::KeyframeSequence::kOversize << "x" << height * mandelbrot::KeyframeSequence::kOversize
+            << " in " << stats.render_seconds << " s (reference " << stats.reference_seconds << " s)" << std::endl;
+  if (!sequence->Save(path))
+    std::cout << "Failed to write " << path << std::endl;
+  return sequence;
+}
+
+int main(int argc, char **argv) {
+  // Point to zoom into, "<re>,<im>" in decimal with as many digits as needed
+  std::string target = "0.36024044343761436323,-0.64131306106480317486";
+  // Decimal digits of zoom from the first frame to the last
+  double depth = 30.0;
+  int frames = 600;
+  int width = 640, height = 360;
+  float max_it = 3000.0f;
+  float color_period = 100.0f;
+  // How frames are made: "strip" resamples them from a log-polar strip of
+  // the zoom, "keyframes" blends them from keyframes one halving apart
+  std::string mode = "strip";
+  // Log-polar strip of the zoom, rendered unless it already holds one deep
+  // enough, so the video can be re-timed without rendering it again
+  std::string strip = "zoom.strip";
+  // Keyframes of the zoom, likewise
+  std::string keyframes = "zoom.keyframes";
+  // Frames are written to <prefix>-00000.ppm, ...
+  std::string prefix = "frame";
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg.rfind("--destination=", 0) == 0)
+      target = arg.substr(14);
+    else if (arg.rfind("--depth=", 0) == 0)
+      depth = std::stod(arg.substr(8));
+    else if (arg.rfind("--frames=", 0) == 0)
+      frames = std::stoi(arg.substr(9));
+    else if (arg.rfind("--size=", 0) == 0)
+      std::sscanf(arg.c_str() + 7, "%dx%d", &width, &height);
+    else if (arg.rfind("--max-it=", 0) == 0)
+      max_it = std::stof(arg.substr(9));
+    else if (arg.rfind("--color-period=", 0) == 0)
+      color_period = std::stof(arg.substr(15));
+    else if (arg.rfind("--mode=", 0) == 0)
+      mode = arg.substr(7);
+    else if (arg.rfind("--strip=", 0) == 0)
+      strip = arg.substr(8);
+    else if (arg.rfind("--keyframes=", 0) == 0)
+      keyframes = arg.substr(12);
+    else if (arg.rfind("--out=", 0) == 0)
+      prefix = arg.substr(6);
+    else {
+      std::cout << "Unknown option \"" << arg << "\"" << std::endl;
+      return -1;
+    }
+  }
+  if (frames < 2 || width <= 0 || height <= 0 || depth <= 0.0) {
+    std::cout << "Expected at least 2 frames, a positive size and a positive depth" << std::endl;
+    return -1;
+  }
+  if (mode != "strip" && mode != "keyframes") {
+    std::cout << "Unknown mode \"" << mode << "\", expected strip or keyframes" << std::endl;
+    return -1;
+  }
+  size_t comma = target.find(',');
+  std::optional<mandelbrot::FixedComplex> destination;
+  if (comma != std::string::npos)
+    destination = mandelbrot::FixedComplex::Parse(std::string_view(target).substr(0, comma), std::string_view(target).substr(comma + 1));
+  if (!destination) {
+    std::cout << "Invalid destination \"" << target << "\", expected <re>,<im> in decimal" << std::endl;
+    return -1;
+  }
+
+  double octaves = depth * std::log2(10.0);
+  mandelbrot::FloatExp start_radius = kStartRadius;
+  std::optional<mandelbrot::ExponentialMap> map;
+  std::optional<mandelbrot::KeyframeSequence> sequence;
+  if (mode == "strip")
+    map = ExponentialMap(strip, *destination, start_radius, start_radius * Pow2(-octaves), width, height, max_it);
+  else
+    sequence = Keyframes(keyframes, *destination, start_radius, octaves, width, height, max_it);
+
+  // Zoom at a constant rate: every frame scales the last by the same factor
+  std::vector<float> iterations(static_cast<size_t>(width) * height);
+  mandelbrot::IterationBuffer frame{iterations.data(), width, height};
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < frames; i++) {
+    mandelbrot::FloatExp radius = start_radius * Pow2(-octaves * i / (frames - 1));
+    if (map)
+      map->Resample(radius, frame);
+    else
+      sequence->Interpolate(radius, frame);
+    char path[32];
+    std::snprintf(path, sizeof(path), "-%05d.ppm", i);
+    if (!WriteFrame(prefix + path, frame, color_period)) {
+      std::cout << "Failed to write " << prefix + path << std::endl;
+      return -1;
+    }
+  }
+  std::cout << (map ? "Resampled " : "Interpolated ") << frames << " frames in " << Seconds(start) << " s" << std::endl;
+  return 0;
+}